@@ -0,0 +1,170 @@
+#ifndef BREAKOUT_ALLOCATION_H
+#define BREAKOUT_ALLOCATION_H
+
+#include "inc/SDL.h"
+#include "inc/SDL_test_memory.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Asignaciones contadas por hilo, para medir zonas del perfilador
+struct AllocationCounts {
+    Uint64 count;
+    Uint64 bytes;
+};
+
+inline AllocationCounts& threadAllocations() {
+    static thread_local AllocationCounts counts = { 0, 0 };
+    return counts;
+}
+
+// Los hilos de fondo (escritor de captura, telemetría) no cuentan para el frame
+inline bool& threadAllocationsIgnored() {
+    static thread_local bool ignored = false;
+    return ignored;
+}
+
+inline void ignoreThreadAllocations() { threadAllocationsIgnored() = true; }
+
+// Totales de todos los hilos que cuentan para el frame
+inline SDL_atomic_t& globalAllocationCount() {
+    static SDL_atomic_t count;
+    return count;
+}
+
+inline SDL_atomic_t& globalAllocationBytes() {
+    static SDL_atomic_t bytes;
+    return bytes;
+}
+
+inline void noteAllocation(size_t size) {
+    AllocationCounts& counts = threadAllocations();
+    ++counts.count;
+    counts.bytes += size;
+    if (!threadAllocationsIgnored()) {
+        SDL_AtomicAdd(&globalAllocationCount(), 1);
+        SDL_AtomicAdd(&globalAllocationBytes(), static_cast<int>(size));
+    }
+}
+
+// Las asignaciones de SDL pasan por SDL_malloc: encima del seguimiento de
+// SDLTest_TrackAllocations (que informa las pérdidas al salir) pongo funciones
+// que solo cuentan y llaman a las anteriores
+struct SDLMemoryFunctions {
+    SDL_malloc_func malloc;
+    SDL_calloc_func calloc;
+    SDL_realloc_func realloc;
+    SDL_free_func free;
+};
+
+inline SDLMemoryFunctions& previousSDLMemoryFunctions() {
+    static SDLMemoryFunctions functions = { nullptr, nullptr, nullptr, nullptr };
+    return functions;
+}
+
+inline void* SDLCALL countingMalloc(size_t size) {
+    noteAllocation(size);
+    return previousSDLMemoryFunctions().malloc(size);
+}
+
+inline void* SDLCALL countingCalloc(size_t count, size_t size) {
+    noteAllocation(count * size);
+    return previousSDLMemoryFunctions().calloc(count, size);
+}
+
+inline void* SDLCALL countingRealloc(void* mem, size_t size) {
+    noteAllocation(size);
+    return previousSDLMemoryFunctions().realloc(mem, size);
+}
+
+inline void SDLCALL countingFree(void* mem) {
+    previousSDLMemoryFunctions().free(mem);
+}
+
+// Antes de SDL_Init, para que todo lo que asigna SDL quede registrado
+inline void trackSDLAllocations() {
+    SDLTest_TrackAllocations();
+    SDLMemoryFunctions& previous = previousSDLMemoryFunctions();
+    SDL_GetMemoryFunctions(&previous.malloc, &previous.calloc, &previous.realloc, &previous.free);
+    SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, countingFree);
+}
+
+// Asignaciones por frame. Pasados warmupFrames el juego tiene que estar en
+// estado estable: con strict, el primer frame que asigne hace fallar la corrida.
+class AllocationTracker {
+public:
+    AllocationTracker(int warmupFrames, bool strict)
+        : warmupFrames(warmupFrames), strict(strict), failedFrame(false), frame(0), startCount(0), startBytes(0),
+          framesWithAllocations(0), steadyAllocations(0), steadyBytes(0), maxPerFrame(0) {}
+
+    bool steady() const { return frame >= static_cast<Uint64>(warmupFrames); }
+    bool failed() const { return failedFrame; }
+
+    void beginFrame() {
+        startCount = static_cast<Uint32>(SDL_AtomicGet(&globalAllocationCount()));
+        startBytes = static_cast<Uint32>(SDL_AtomicGet(&globalAllocationBytes()));
+    }
+
+    // false si strict y el frame asignó en estado estable
+    bool endFrame() {
+        Uint32 count = static_cast<Uint32>(SDL_AtomicGet(&globalAllocationCount())) - startCount;
+        Uint32 bytes = static_cast<Uint32>(SDL_AtomicGet(&globalAllocationBytes())) - startBytes;
+        bool ok = true;
+        if (count > 0) {
+            ++framesWithAllocations;
+            if (count > maxPerFrame) maxPerFrame = count;
+            if (steady()) {
+                steadyAllocations += count;
+                steadyBytes += bytes;
+                if (strict) {
+                    failedFrame = true;
+                    printf("Asignacion en estado estable: frame %llu, %u asignaciones, %u bytes\n",
+                           static_cast<unsigned long long>(frame), count, bytes);
+                    ok = false;
+                }
+            }
+        }
+        ++frame;
+        return ok;
+    }
+
+    void printStats() const {
+        printf("Asignaciones: %llu frames, %llu con asignaciones, maximo %u por frame; despues de %d frames de calentamiento: %llu asignaciones, %llu bytes\n",
+               static_cast<unsigned long long>(frame), static_cast<unsigned long long>(framesWithAllocations), maxPerFrame,
+               warmupFrames, static_cast<unsigned long long>(steadyAllocations), static_cast<unsigned long long>(steadyBytes));
+    }
+
+private:
+    int warmupFrames;
+    bool strict;
+    bool failedFrame;
+    Uint64 frame;
+    Uint32 startCount, startBytes;
+    Uint64 framesWithAllocations, steadyAllocations, steadyBytes;
+    Uint32 maxPerFrame;
+};
+
+// Reemplazo global de new/delete que cuenta cada asignación. Se define en un
+// solo archivo, el que tiene main(), con BREAKOUT_ALLOCATION_HOOKS.
+#ifdef BREAKOUT_ALLOCATION_HOOKS
+void* operator new(size_t size) {
+    noteAllocation(size);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    noteAllocation(size);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+#endif
+
+#endif
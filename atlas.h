@@ -0,0 +1,158 @@
+#ifndef BREAKOUT_ATLAS_H
+#define BREAKOUT_ATLAS_H
+
+#include "inc/SDL.h"
+#include "render_commands.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Empaquetador por estantes: ordeno por alto y voy llenando filas de
+// izquierda a derecha. Para pocos sprites de tamaños parecidos alcanza.
+inline bool packRects(std::vector<SDL_Rect>& rects, int width, int height, int padding) {
+    std::vector<int> order(rects.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return rects[a].h > rects[b].h; });
+
+    int x = padding, y = padding, shelfHeight = 0;
+    for (int index : order) {
+        SDL_Rect& r = rects[index];
+        if (x + r.w + padding > width) {
+            x = padding;
+            y += shelfHeight + padding;
+            shelfHeight = 0;
+        }
+        if (r.w + 2 * padding > width || y + r.h + padding > height) return false;
+        r.x = x;
+        r.y = y;
+        x += r.w + padding;
+        shelfHeight = std::max(shelfHeight, r.h);
+    }
+    return true;
+}
+
+// Todas las imágenes en una sola textura. El sprite 0 es un texel blanco
+// para dibujar rectángulos sólidos en el mismo lote que los sprites.
+class TextureAtlas {
+public:
+    struct UV { float u0, v0, u1, v1; };
+
+    TextureAtlas() : texture(nullptr) {
+        SDL_Surface* white = SDL_CreateRGBSurfaceWithFormat(0, 2, 2, 32, SDL_PIXELFORMAT_ARGB8888);
+        SDL_FillRect(white, NULL, 0xFFFFFFFF);
+        add("white", white);
+    }
+
+    ~TextureAtlas() {
+        for (auto& image : images) SDL_FreeSurface(image.surface);
+        if (texture) SDL_DestroyTexture(texture);
+    }
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // El atlas se queda con la surface; devuelve el id del sprite
+    Uint16 add(const char* name, SDL_Surface* surface) {
+        images.push_back({ name, surface, { 0, 0, surface->w, surface->h } });
+        return static_cast<Uint16>(images.size() - 1);
+    }
+
+    // Empaqueto, copio las imágenes a una surface y creo la textura
+    bool build(SDL_Renderer* renderer) {
+        std::vector<SDL_Rect> rects;
+        for (const auto& image : images) rects.push_back(image.rect);
+
+        int size = 256;
+        while (!packRects(rects, size, size, 1)) {
+            size *= 2;
+            if (size > 4096) return false;
+        }
+
+        SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+        SDL_FillRect(atlas, NULL, 0);
+        uvs.resize(images.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+            images[i].rect = rects[i];
+            SDL_SetSurfaceBlendMode(images[i].surface, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(images[i].surface, NULL, atlas, &images[i].rect);
+
+            const SDL_Rect& r = images[i].rect;
+            uvs[i] = { static_cast<float>(r.x) / size, static_cast<float>(r.y) / size,
+                       static_cast<float>(r.x + r.w) / size, static_cast<float>(r.y + r.h) / size };
+        }
+        // El texel blanco se muestrea en su centro, así no se mezcla con vecinos
+        float cu = (images[0].rect.x + 1.0f) / size, cv = (images[0].rect.y + 1.0f) / size;
+        uvs[0] = { cu, cv, cu, cv };
+
+        if (texture) SDL_DestroyTexture(texture);
+        texture = SDL_CreateTextureFromSurface(renderer, atlas);
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        SDL_FreeSurface(atlas);
+        return texture != nullptr;
+    }
+
+    SDL_Texture* getTexture() const { return texture; }
+    const UV& uv(Uint16 sprite) const { return uvs[sprite < uvs.size() ? sprite : 0]; }
+    const SDL_Rect& rect(Uint16 sprite) const { return images[sprite].rect; }
+
+    int find(const char* name) const {
+        for (size_t i = 0; i < images.size(); ++i) {
+            if (images[i].name == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+private:
+    struct Image {
+        std::string name;
+        SDL_Surface* surface;
+        SDL_Rect rect;
+    };
+
+    std::vector<Image> images;
+    std::vector<UV> uvs;
+    SDL_Texture* texture;
+};
+
+// Convierte una lista de comandos ordenada en quads con UVs del atlas y color
+// de modulación, y la dibuja con una sola llamada a SDL_RenderGeometry
+class SpriteBatch {
+public:
+    void begin() {
+        vertices.clear();
+        indices.clear();
+    }
+
+    void add(const TextureAtlas& atlas, const SDL_Rect& rect, SDL_Color color, Uint16 sprite) {
+        const TextureAtlas::UV& uv = atlas.uv(sprite);
+        const float x0 = static_cast<float>(rect.x), y0 = static_cast<float>(rect.y);
+        const float x1 = x0 + rect.w, y1 = y0 + rect.h;
+        const int base = static_cast<int>(vertices.size());
+
+        vertices.push_back({ { x0, y0 }, color, { uv.u0, uv.v0 } });
+        vertices.push_back({ { x1, y0 }, color, { uv.u1, uv.v0 } });
+        vertices.push_back({ { x1, y1 }, color, { uv.u1, uv.v1 } });
+        vertices.push_back({ { x0, y1 }, color, { uv.u0, uv.v1 } });
+
+        const int quad[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int i : quad) indices.push_back(base + i);
+    }
+
+    void add(const TextureAtlas& atlas, const RenderCommand* commands, int count) {
+        for (int i = 0; i < count; ++i) add(atlas, commands[i].rect, commands[i].color, commands[i].texture);
+    }
+
+    // Una llamada de dibujo para todo el lote
+    int draw(SDL_Renderer* renderer, const TextureAtlas& atlas) {
+        if (indices.empty()) return 0;
+        SDL_RenderGeometry(renderer, atlas.getTexture(), vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+        return 1;
+    }
+
+private:
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+#endif
@@ -0,0 +1,494 @@
+#define SDL_MAIN_HANDLED
+#include "inc/SDL.h"
+#include "breakout.h"
+#include "state_hash.h"
+#include "world_snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Benchmarks del juego: ECS, colisiones, render sin ventana y frames completos
+// a distintos tamaños de mundo. Cada caso corre unas repeticiones de
+// calentamiento y después mide; se informa el tiempo por operación.
+//
+//   bench [--reps N] [--warmup N] [--filter TEXTO] [--json FILE]
+//         [--baseline FILE] [--tolerance 0.10]
+//
+// Con --baseline se compara la media de cada caso contra la del archivo y se
+// sale con código 1 si alguno empeoró más que la tolerancia o si ningún caso
+// del archivo coincide con los medidos.
+
+struct BenchOptions {
+    int reps = 20;
+    int warmup = 3;
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double tolerance = 0.10;
+};
+
+struct BenchResult {
+    std::string name;
+    int reps;
+    Uint64 opsPerRep;
+    double meanNs, stddevNs, minNs, medianNs, p95Ns; // por operación
+};
+
+// Una repetición: prepara lo que necesite, mide solo lo que importa con
+// start/stop y devuelve cuántas operaciones hizo
+class BenchTimer {
+public:
+    void start() { begin = SDL_GetPerformanceCounter(); }
+    void stop() { elapsed += SDL_GetPerformanceCounter() - begin; }
+    Uint64 elapsed = 0;
+
+private:
+    Uint64 begin = 0;
+};
+
+typedef std::function<Uint64(BenchTimer&)> BenchFunction;
+
+BenchResult runBench(const std::string& name, const BenchOptions& options, const BenchFunction& fn) {
+    for (int i = 0; i < options.warmup; ++i) {
+        BenchTimer timer;
+        fn(timer);
+    }
+
+    const double nsPerTick = 1e9 / SDL_GetPerformanceFrequency();
+    std::vector<double> samples;
+    Uint64 ops = 0;
+    for (int i = 0; i < options.reps; ++i) {
+        BenchTimer timer;
+        ops = fn(timer);
+        samples.push_back(timer.elapsed * nsPerTick / (ops ? ops : 1));
+    }
+
+    BenchResult r;
+    r.name = name;
+    r.reps = options.reps;
+    r.opsPerRep = ops;
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    r.meanNs = sum / samples.size();
+    double var = 0.0;
+    for (double s : samples) var += (s - r.meanNs) * (s - r.meanNs);
+    r.stddevNs = samples.size() > 1 ? std::sqrt(var / (samples.size() - 1)) : 0.0;
+    std::sort(samples.begin(), samples.end());
+    r.minNs = samples.front();
+    r.medianNs = samples[samples.size() / 2];
+    r.p95Ns = samples[std::min(samples.size() - 1, static_cast<size_t>(samples.size() * 0.95))];
+    return r;
+}
+
+// Mundo con count bloques sueltos, para los casos de ECS
+void fillBlocks(ECS& ecs, int count) {
+    for (int i = 0; i < count; ++i) {
+        int block = ecs.createEntity();
+        ecs.positions[block] = { static_cast<float>(rand() % SCREEN_WIDTH), static_cast<float>(rand() % (SCREEN_HEIGHT * 10)) };
+        ecs.colors[block] = { getRandomColor() };
+        ecs.sprites[block] = { SPRITE_BLOCK };
+        ecs.blocks[block] = { true };
+    }
+}
+
+// Mundo con count bloques en un nivel de screens pantallas, con la grilla armada.
+// Las posiciones salen de un xorshift32 y no de rand(): con RAND_MAX = 32767
+// (MinGW) un nivel de 1000 pantallas tendría todos los bloques arriba de todo.
+void fillLevel(ECS& ecs, int count, int screens) {
+    ecs.worldHeight = SCREEN_HEIGHT * screens;
+    ecs.blockGrid.reset(SCREEN_WIDTH, ecs.worldHeight, GRID_CELL);
+    Uint32 rng = static_cast<Uint32>(rand()) | 1; // sigue la semilla de srand() del caso
+    auto next = [&rng](int range) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return static_cast<int>(rng % static_cast<Uint32>(range));
+    };
+    for (int i = 0; i < count; ++i) {
+        int block = ecs.createEntity();
+        Position p = { static_cast<float>(next(SCREEN_WIDTH - BLOCK_WIDTH)), static_cast<float>(next(ecs.worldHeight - BLOCK_HEIGHT)) };
+        ecs.positions[block] = p;
+        ecs.colors[block] = { getRandomColor() };
+        ecs.sprites[block] = { SPRITE_BLOCK };
+        ecs.blocks[block] = { true };
+        ecs.blockGrid.insert(block, p.x, p.y, BLOCK_WIDTH, BLOCK_HEIGHT);
+    }
+    ecs.blocksLeft = count;
+}
+
+// Foto con count bloques al azar dentro de la pantalla
+void fillSnapshot(RenderSnapshot& snapshot, int count) {
+    snapshot.items.clear();
+    for (int i = 0; i < count; ++i) {
+        float x = static_cast<float>(rand() % (SCREEN_WIDTH - BLOCK_WIDTH));
+        float y = static_cast<float>(rand() % (SCREEN_HEIGHT - BLOCK_HEIGHT));
+        snapshot.items.push_back({ x, y, BLOCK_WIDTH, BLOCK_HEIGHT, getRandomColor(), SPRITE_BLOCK, LAYER_BLOCKS, true });
+    }
+}
+
+// Render por software de SDL sobre una surface, con atlas o sin él
+struct HeadlessRender {
+    SDL_Surface* target;
+    WorkerPool pool;
+    RenderContext ctx;
+
+    explicit HeadlessRender(bool atlas) : pool(1) {
+        target = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+        ctx.renderer = SDL_CreateSoftwareRenderer(target);
+        ctx.pool = &pool;
+        ctx.commands.setWorkers(pool.size());
+        if (atlas) ctx.atlas = createAtlas(ctx.renderer);
+    }
+
+    ~HeadlessRender() {
+        delete ctx.atlas;
+        SDL_DestroyRenderer(ctx.renderer);
+        SDL_FreeSurface(target);
+    }
+};
+
+std::vector<BenchResult> runAll(const BenchOptions& options) {
+    std::vector<BenchResult> results;
+    auto add = [&](const std::string& name, const BenchFunction& fn) {
+        if (options.filter && name.find(options.filter) == std::string::npos) return;
+        BenchResult r = runBench(name, options, fn);
+        printf("%-36s %12.1f ns/op  (+-%.1f, min %.1f, mediana %.1f, p95 %.1f, %llu ops x %d)\n", r.name.c_str(),
+               r.meanNs, r.stddevNs, r.minNs, r.medianNs, r.p95Ns, static_cast<unsigned long long>(r.opsPerRep), r.reps);
+        fflush(stdout);
+        results.push_back(r);
+    };
+
+    const int sizes[] = { 1000, 10000, 100000 };
+    for (int n : sizes) {
+        std::string suffix = "/" + std::to_string(n);
+
+        add("ecs.create" + suffix, [n](BenchTimer& t) {
+            ECS ecs;
+            t.start();
+            fillBlocks(ecs, n);
+            t.stop();
+            return static_cast<Uint64>(n);
+        });
+
+        ECS world;
+        fillBlocks(world, n);
+        std::vector<int> ids;
+        for (const auto& block : world.blocks) ids.push_back(block.first);
+        std::vector<int> shuffled = ids;
+        srand(7);
+        for (size_t i = shuffled.size(); i > 1; --i) std::swap(shuffled[i - 1], shuffled[rand() % i]);
+
+        add("ecs.lookup" + suffix, [&world, &shuffled](BenchTimer& t) {
+            float sum = 0.0f;
+            t.start();
+            for (int id : shuffled) sum += world.positions[id].x;
+            t.stop();
+            if (sum < 0.0f) printf("%f", sum); // que el compilador no lo borre
+            return static_cast<Uint64>(shuffled.size());
+        });
+
+        add("ecs.iterate" + suffix, [&world](BenchTimer& t) {
+            float sum = 0.0f;
+            t.start();
+            for (const auto& pos : world.positions) sum += pos.second.x + pos.second.y;
+            t.stop();
+            if (sum < 0.0f) printf("%f", sum);
+            return static_cast<Uint64>(world.positions.size());
+        });
+
+        add("collision.check" + suffix, [&world, &ids](BenchTimer& t) {
+            Position ball = { SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT * 5.0f };
+            int hits = 0;
+            t.start();
+            for (int id : ids) hits += checkCollision(ball, world.positions[id], BLOCK_WIDTH, BLOCK_HEIGHT);
+            t.stop();
+            if (hits < 0) printf("%d", hits);
+            return static_cast<Uint64>(ids.size());
+        });
+
+        // Pasada de una pelota contra todos los bloques, como hacía update()
+        // antes de la grilla, contra la consulta a la grilla
+        add("collision.blocks_scan" + suffix, [&world](BenchTimer& t) {
+            Position ball = { SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT * 5.0f };
+            int hits = 0;
+            t.start();
+            for (auto& block : world.blocks) {
+                if (block.second.active && checkCollision(ball, world.positions[block.first], BLOCK_WIDTH, BLOCK_HEIGHT)) ++hits;
+            }
+            t.stop();
+            if (hits < 0) printf("%d", hits);
+            return static_cast<Uint64>(1);
+        });
+
+        SpatialGrid grid;
+        grid.reset(SCREEN_WIDTH, SCREEN_HEIGHT * 10, GRID_CELL);
+        for (int id : ids) grid.insert(id, world.positions[id].x, world.positions[id].y, BLOCK_WIDTH, BLOCK_HEIGHT);
+        add("collision.blocks_grid" + suffix, [&world, &grid](BenchTimer& t) {
+            Position ball = { SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT * 5.0f };
+            std::vector<int> nearby;
+            nearby.reserve(1024);
+            int hits = 0;
+            t.start();
+            grid.query(ball.x, ball.y, BALL_SIZE, BALL_SIZE, nearby);
+            for (int id : nearby) hits += checkCollision(ball, world.positions[id], BLOCK_WIDTH, BLOCK_HEIGHT);
+            t.stop();
+            if (hits < 0) printf("%d", hits);
+            return static_cast<Uint64>(1);
+        });
+    }
+
+    // Guardar y restaurar el mundo entero; una operación es un KB de la foto,
+    // así el resultado queda en ns por KB. ecs.copy es la copia con operator=
+    // de los contenedores, para comparar.
+    const int snapshotSizes[] = { 1000, 10000, 100000, 1000000 };
+    for (int n : snapshotSizes) {
+        std::string suffix = "/" + std::to_string(n);
+        srand(5);
+        ECS world;
+        fillLevel(world, n, 1 + n / 1000);
+        WorldSnapshot snapshot;
+        snapshot.save(world);
+        const Uint64 kb = (snapshot.size() + 1023) / 1024;
+
+        add("snapshot.save" + suffix, [&world, &snapshot, kb](BenchTimer& t) {
+            t.start();
+            snapshot.save(world);
+            t.stop();
+            return kb;
+        });
+
+        ECS restored;
+        snapshot.restore(restored); // la primera vez asigna; se mide sobre un mundo con capacidad
+        add("snapshot.restore" + suffix, [&restored, &snapshot, kb](BenchTimer& t) {
+            t.start();
+            bool ok = snapshot.restore(restored);
+            t.stop();
+            if (!ok) printf("la foto no se pudo restaurar\n");
+            return kb;
+        });
+
+        ECS copy;
+        add("ecs.copy" + suffix, [&world, &copy, kb](BenchTimer& t) {
+            t.start();
+            copy = world;
+            t.stop();
+            return kb;
+        });
+    }
+
+    // Hash del mundo (state_hash.h): packWorld() y CRC32, lo que el versus
+    // calcula por frame confirmado y las grabaciones por tick
+    {
+        srand(1);
+        ECS ecs;
+        initializeVersus(ecs);
+        WorldHasher hasher;
+        add("world.hash/versus", [&ecs, &hasher](BenchTimer& t) {
+            t.start();
+            hasher.hash(ecs);
+            t.stop();
+            return static_cast<Uint64>(1);
+        });
+    }
+
+    // Rollback del versus en red: restaurar la foto de hace N frames y resimular
+    // hasta el presente, con los dos paddles en piloto automático
+    const int rollbackDepths[] = { 1, 8, 16 };
+    for (int depth : rollbackDepths) {
+        srand(1);
+        ECS ecs;
+        initializeVersus(ecs);
+        for (int i = 0; i < 300; ++i) {
+            applyInput(ecs, autopilotInput(ecs, 0) | autopilotInput(ecs, 1));
+            update(ecs, 1.0f / MAX_FPS);
+        }
+        WorldSnapshot past, frameSnapshot;
+        past.save(ecs);
+        add("rollback.resim/" + std::to_string(depth) + "frames", [&ecs, &past, &frameSnapshot, depth](BenchTimer& t) {
+            t.start();
+            past.restore(ecs);
+            for (int i = 0; i < depth; ++i) {
+                frameSnapshot.save(ecs); // como la sesión, que guarda la foto de cada frame resimulado
+                applyInput(ecs, autopilotInput(ecs, 0) | autopilotInput(ecs, 1));
+                update(ecs, 1.0f / MAX_FPS);
+            }
+            t.stop();
+            past.restore(ecs);
+            return static_cast<Uint64>(1);
+        });
+    }
+
+    // render() sin ventana con fotos de distintos tamaños
+    const int renderSizes[] = { 100, 1000, 10000 };
+    for (int atlas = 0; atlas < 2; ++atlas) {
+        HeadlessRender headless(atlas != 0);
+        for (int n : renderSizes) {
+            RenderSnapshot snapshot;
+            srand(11);
+            fillSnapshot(snapshot, n);
+            add(std::string(atlas ? "render.atlas/" : "render.flat/") + std::to_string(n), [&](BenchTimer& t) {
+                t.start();
+                render(snapshot, headless.ctx);
+                t.stop();
+                return static_cast<Uint64>(1);
+            });
+        }
+    }
+
+    // Frames completos (input del piloto, update, foto y render) según el alto del nivel
+    const int levels[] = { 1, 10, 100 };
+    HeadlessRender headless(true);
+    for (int screens : levels) {
+        srand(1);
+        ECS ecs;
+        initializeEntities(ecs, screens);
+        RenderSnapshot snapshot;
+        const int frames = 120;
+        add("frame.update/" + std::to_string(screens) + "screens", [&](BenchTimer& t) {
+            for (int i = 0; i < frames; ++i) {
+                applyInput(ecs, autopilotInput(ecs));
+                t.start();
+                GameStatus status = update(ecs, 1.0f / MAX_FPS);
+                t.stop();
+                if (status != GameStatus::Running) {
+                    srand(1);
+                    ecs = ECS();
+                    initializeEntities(ecs, screens);
+                }
+            }
+            return static_cast<Uint64>(frames);
+        });
+        add("frame.full/" + std::to_string(screens) + "screens", [&](BenchTimer& t) {
+            for (int i = 0; i < frames; ++i) {
+                t.start();
+                applyInput(ecs, autopilotInput(ecs));
+                GameStatus status = update(ecs, 1.0f / MAX_FPS);
+                buildSnapshot(ecs, snapshot);
+                render(snapshot, headless.ctx);
+                t.stop();
+                if (status != GameStatus::Running) {
+                    srand(1);
+                    ecs = ECS();
+                    initializeEntities(ecs, screens);
+                }
+            }
+            return static_cast<Uint64>(frames);
+        });
+    }
+    return results;
+}
+
+// Un resultado por renglón, así la línea base se lee sin un parser de JSON
+bool writeJson(const char* path, const std::vector<BenchResult>& results) {
+    FILE* out = fopen(path, "w");
+    if (!out) return false;
+    fprintf(out, "{\"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        fprintf(out, "{\"name\": \"%s\", \"reps\": %d, \"ops\": %llu, \"mean_ns\": %.3f, \"stddev_ns\": %.3f, \"min_ns\": %.3f, \"median_ns\": %.3f, \"p95_ns\": %.3f}%s\n",
+                r.name.c_str(), r.reps, static_cast<unsigned long long>(r.opsPerRep), r.meanNs, r.stddevNs, r.minNs,
+                r.medianNs, r.p95Ns, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "]}\n");
+    fclose(out);
+    return true;
+}
+
+bool readBaseline(const char* path, std::vector<std::pair<std::string, double>>& baseline) {
+    FILE* in = fopen(path, "r");
+    if (!in) return false;
+    char line[512];
+    while (fgets(line, sizeof(line), in)) {
+        char name[128];
+        double mean;
+        const char* p = strstr(line, "\"name\": \"");
+        const char* m = strstr(line, "\"mean_ns\": ");
+        if (!p || !m) continue;
+        if (sscanf(p, "\"name\": \"%127[^\"]\"", name) == 1 && sscanf(m, "\"mean_ns\": %lf", &mean) == 1) {
+            baseline.push_back({ name, mean });
+        }
+    }
+    fclose(in);
+    return true;
+}
+
+// Comparo la media de cada caso contra la línea base; cuento las regresiones.
+// Los casos de la base que no se midieron (renombrados, o fuera de --filter)
+// se listan aparte; si no coincide ninguno devuelvo -1, porque "0 regresiones"
+// sin nada comparado no dice nada.
+int compareBaseline(const std::vector<BenchResult>& results, const std::vector<std::pair<std::string, double>>& baseline, double tolerance) {
+    int regressions = 0, matched = 0;
+    printf("\n%-36s %12s %12s %8s\n", "caso", "base ns/op", "ahora ns/op", "cambio");
+    for (const auto& r : results) {
+        for (const auto& b : baseline) {
+            if (b.first != r.name) continue;
+            double change = b.second > 0.0 ? (r.meanNs - b.second) / b.second : 0.0;
+            bool regressed = change > tolerance;
+            regressions += regressed;
+            ++matched;
+            printf("%-36s %12.1f %12.1f %+7.1f%%%s\n", r.name.c_str(), b.second, r.meanNs, change * 100.0, regressed ? "  REGRESION" : "");
+        }
+    }
+    int missing = 0;
+    for (const auto& b : baseline) {
+        bool measured = false;
+        for (const auto& r : results) measured = measured || r.name == b.first;
+        if (measured) continue;
+        printf("%-36s %12.1f %12s\n", b.first.c_str(), b.second, "sin medir");
+        ++missing;
+    }
+    if (missing > 0) printf("%d casos de la linea base no se midieron\n", missing);
+    if (matched == 0) {
+        printf("Ningun caso coincide con la linea base (%zu casos en el archivo)\n", baseline.size());
+        return -1;
+    }
+    printf("%d regresiones por encima de %.0f%% en %d casos comparados\n", regressions, tolerance * 100.0, matched);
+    return regressions;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            options.reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            options.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            options.baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            options.tolerance = atof(argv[++i]);
+        } else {
+            printf("Opcion desconocida: %s\n", argv[i]);
+        }
+    }
+    if (options.reps < 1) options.reps = 1;
+
+    SDL_Init(0);
+    std::vector<BenchResult> results = runAll(options);
+
+    int status = 0;
+    if (options.jsonPath && !writeJson(options.jsonPath, results)) {
+        printf("No pude escribir %s\n", options.jsonPath);
+        status = 1;
+    }
+    if (options.baselinePath) {
+        std::vector<std::pair<std::string, double>> baseline;
+        if (!readBaseline(options.baselinePath, baseline)) {
+            printf("No pude leer la linea base %s\n", options.baselinePath);
+            status = 1;
+        } else if (compareBaseline(results, baseline, options.tolerance) != 0) {
+            status = 1;
+        }
+    }
+    SDL_Quit();
+    return status;
+}
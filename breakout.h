@@ -0,0 +1,563 @@
+#ifndef BREAKOUT_GAME_H
+#define BREAKOUT_GAME_H
+
+// El juego en sí: componentes, ECS, reglas, foto para el render y render.
+// Lo comparten tarea.cpp y bench.cpp.
+
+#include "inc/SDL.h"
+#include "atlas.h"
+#include "component_map.h"
+#include "hud.h"
+#include "particles.h"
+#include "perf_counters.h"
+#include "profiler.h"
+#include "render_commands.h"
+#include "render_snapshot.h"
+#include "spatial.h"
+#include "sprites.h"
+#include "tiles.h"
+#include "workers.h"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+const int SCREEN_WIDTH = 750;
+const int SCREEN_HEIGHT = 480;
+const int MAX_FPS = 60;
+const int BALL_SPEED = 200;
+const int BALL_SIZE = 20;
+const int PADDLE_WIDTH = 100;
+const int PADDLE_HEIGHT = 20;
+const int BLOCK_WIDTH = 60;
+const int BLOCK_HEIGHT = 20;
+const int BLOCK_ROWS = 5;
+const int BLOCK_COLUMNS = 10;
+const int PADDLE_SPEED = 300;
+const int GRID_CELL = 128;      // lado de las celdas de la grilla espacial
+const int SLEEP_MARGIN = SCREEN_HEIGHT; // lo que está más lejos de la cámara no se simula
+const int VERSUS_POINTS = 5;    // tantos para ganar un versus
+
+// Estructuro los componentes
+struct Position {
+    float x, y;
+};
+
+struct Velocity {
+    float vx, vy;
+};
+
+struct Color {
+    SDL_Color color;
+};
+
+struct Sprite {
+    Uint16 id; // SpriteId en el atlas
+};
+
+// Vista sobre el mundo; el render solo ve lo que cae dentro
+struct Camera {
+    float x, y;
+    int w, h;
+};
+
+// player 0 juega abajo y 1 arriba (solo en versus); points son sus tantos en versus
+struct Paddle {
+    int player;
+    int points;
+};
+struct Ball {};
+struct Block { bool active; };
+
+// Clase para entidades
+class Entity {
+public:
+    int id;
+    Entity(int id) : id(id) {}
+};
+
+// Clase ECS para gestionar componentes
+class ECS {
+public:
+    ComponentMap<Position> positions;
+    ComponentMap<Velocity> velocities;
+    ComponentMap<Color> colors;
+    ComponentMap<Sprite> sprites;
+    ComponentMap<Paddle> paddles;
+    ComponentMap<Ball> balls;
+    ComponentMap<Block> blocks;
+    ComponentMap<Camera> cameras;
+    SpatialGrid blockGrid;  // bloques activos por celda
+    int worldHeight = SCREEN_HEIGHT;
+    int blocksLeft = 0;
+    int score = 0;
+    std::vector<BreakEvent> events; // bloques rotos en el último update()
+    std::vector<int> nearbyBlocks;  // resultado de consultas a la grilla, reutilizado
+
+    int nextEntity = 0; // cada mundo numera sus entidades desde 0
+
+    int createEntity() {
+        return nextEntity++;
+    }
+};
+
+inline SDL_Color getRandomColor() {
+    return { static_cast<Uint8>(rand() % 256), static_cast<Uint8>(rand() % 256), static_cast<Uint8>(rand() % 256), 0xFF };
+}
+
+// Inicializo bloques con ECS: una tanda de filas arriba de cada pantalla del nivel
+inline void initializeBlocks(ECS &ecs, int screens) {
+    ecs.blockGrid.reset(SCREEN_WIDTH, ecs.worldHeight, GRID_CELL);
+    for (int s = 0; s < screens; ++s) {
+        for (int i = 0; i < BLOCK_ROWS; ++i) {
+            for (int j = 0; j < BLOCK_COLUMNS; ++j) {
+                int block = ecs.createEntity();
+                ecs.positions[block] = { j * (BLOCK_WIDTH + 10) + 35.0f, s * SCREEN_HEIGHT + i * (BLOCK_HEIGHT + 10) + 30.0f };
+                ecs.colors[block] = { getRandomColor() };
+                ecs.sprites[block] = { SPRITE_BLOCK };
+                ecs.blocks[block] = { true };
+                ecs.blockGrid.insert(block, ecs.positions[block].x, ecs.positions[block].y, BLOCK_WIDTH, BLOCK_HEIGHT);
+                ++ecs.blocksLeft;
+            }
+        }
+    }
+}
+
+// Buffers de trabajo de update() y buildSnapshot(), reservados de entrada
+inline void reserveScratch(ECS &ecs) {
+    ecs.events.reserve(16);
+    // Candidatos de una consulta con la cámara: lo visible más una celda de cada lado
+    ecs.nearbyBlocks.reserve(BLOCK_COLUMNS * ((SCREEN_HEIGHT + 2 * GRID_CELL) / (BLOCK_HEIGHT + 10) + 2));
+}
+
+// Inicializo entidades ECS. El nivel mide screens pantallas de alto y el
+// paddle arranca abajo de todo.
+inline void initializeEntities(ECS &ecs, int screens = 1) {
+    ecs.worldHeight = screens * SCREEN_HEIGHT;
+    const float bottom = static_cast<float>(ecs.worldHeight - SCREEN_HEIGHT);
+
+    int paddle = ecs.createEntity();
+    ecs.positions[paddle] = { (SCREEN_WIDTH - PADDLE_WIDTH) / 2.0f, bottom + SCREEN_HEIGHT - PADDLE_HEIGHT - 10.0f };
+    ecs.velocities[paddle] = { 0.0f, 0.0f };
+    ecs.colors[paddle] = { {0xFF, 0xFF, 0xFF, 0xFF} };
+    ecs.sprites[paddle] = { SPRITE_PADDLE };
+    ecs.paddles[paddle] = {};
+
+    int ball = ecs.createEntity();
+    ecs.positions[ball] = { SCREEN_WIDTH / 2.0f, bottom + SCREEN_HEIGHT / 2.0f };
+    ecs.velocities[ball] = { BALL_SPEED, BALL_SPEED };
+    ecs.colors[ball] = { {0xFF, 0xFF, 0xFF, 0xFF} };
+    ecs.sprites[ball] = { SPRITE_BALL };
+    ecs.balls[ball] = {};
+
+    initializeBlocks(ecs, screens);
+    reserveScratch(ecs);
+
+    int camera = ecs.createEntity();
+    ecs.positions[camera] = { 0.0f, bottom };
+    ecs.cameras[camera] = { 0.0f, bottom, SCREEN_WIDTH, SCREEN_HEIGHT };
+}
+
+// Versus para dos jugadores en una pantalla: un paddle abajo (jugador 0),
+// otro arriba (jugador 1) y los bloques compartidos en el medio. Si la pelota
+// pasa a un jugador, el otro suma un tanto y se vuelve a sacar.
+inline void initializeVersus(ECS &ecs) {
+    ecs.worldHeight = SCREEN_HEIGHT;
+    const SDL_Color colors[2] = { { 0xFF, 0xFF, 0xFF, 0xFF }, { 0xFF, 0xC0, 0x40, 0xFF } };
+    const float y[2] = { SCREEN_HEIGHT - PADDLE_HEIGHT - 10.0f, 10.0f };
+    for (int player = 0; player < 2; ++player) {
+        int paddle = ecs.createEntity();
+        ecs.positions[paddle] = { (SCREEN_WIDTH - PADDLE_WIDTH) / 2.0f, y[player] };
+        ecs.velocities[paddle] = { 0.0f, 0.0f };
+        ecs.colors[paddle] = { colors[player] };
+        ecs.sprites[paddle] = { SPRITE_PADDLE };
+        ecs.paddles[paddle] = { player, 0 };
+    }
+
+    int ball = ecs.createEntity();
+    ecs.positions[ball] = { SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT * 0.75f };
+    ecs.velocities[ball] = { BALL_SPEED, BALL_SPEED };
+    ecs.colors[ball] = { {0xFF, 0xFF, 0xFF, 0xFF} };
+    ecs.sprites[ball] = { SPRITE_BALL };
+    ecs.balls[ball] = {};
+
+    // Las filas de bloques centradas en vertical
+    ecs.blockGrid.reset(SCREEN_WIDTH, ecs.worldHeight, GRID_CELL);
+    const float top = (SCREEN_HEIGHT - BLOCK_ROWS * (BLOCK_HEIGHT + 10)) / 2.0f;
+    for (int i = 0; i < BLOCK_ROWS; ++i) {
+        for (int j = 0; j < BLOCK_COLUMNS; ++j) {
+            int block = ecs.createEntity();
+            ecs.positions[block] = { j * (BLOCK_WIDTH + 10) + 35.0f, top + i * (BLOCK_HEIGHT + 10) };
+            ecs.colors[block] = { getRandomColor() };
+            ecs.sprites[block] = { SPRITE_BLOCK };
+            ecs.blocks[block] = { true };
+            ecs.blockGrid.insert(block, ecs.positions[block].x, ecs.positions[block].y, BLOCK_WIDTH, BLOCK_HEIGHT);
+            ++ecs.blocksLeft;
+        }
+    }
+    reserveScratch(ecs);
+
+    int camera = ecs.createEntity();
+    ecs.positions[camera] = { 0.0f, 0.0f };
+    ecs.cameras[camera] = { 0.0f, 0.0f, SCREEN_WIDTH, SCREEN_HEIGHT };
+}
+
+inline const Camera& mainCamera(ECS &ecs) {
+    static const Camera fixed = { 0.0f, 0.0f, SCREEN_WIDTH, SCREEN_HEIGHT };
+    return ecs.cameras.empty() ? fixed : ecs.cameras.begin()->second;
+}
+
+// La cámara sigue en vertical a la primera pelota sin salirse del nivel
+inline void updateCamera(ECS &ecs) {
+    if (ecs.balls.empty()) return;
+    const Position& ball = ecs.positions[ecs.balls.begin()->first];
+    for (auto& camera : ecs.cameras) {
+        float y = ball.y + BALL_SIZE / 2.0f - camera.second.h / 2.0f;
+        float maxY = static_cast<float>(ecs.worldHeight - camera.second.h);
+        camera.second.y = y < 0.0f ? 0.0f : (y > maxY ? maxY : y);
+        ecs.positions[camera.first] = { camera.second.x, camera.second.y };
+    }
+}
+
+// Lo que está a más de SLEEP_MARGIN de la cámara duerme: no se mueve ni choca
+inline bool isAwake(const Camera& camera, const Position& pos) {
+    return pos.y > camera.y - SLEEP_MARGIN && pos.y < camera.y + camera.h + SLEEP_MARGIN;
+}
+
+// Botones del jugador. En versus la entrada de un tick lleva los de los dos:
+// los del jugador p van corridos 2 * p bits (ver playerInput()).
+enum { INPUT_LEFT = 1, INPUT_RIGHT = 2 };
+const int INPUT_BITS = 2;
+
+inline Uint32 playerInput(Uint32 buttons, int player) {
+    return (buttons & (INPUT_LEFT | INPUT_RIGHT)) << (INPUT_BITS * player);
+}
+
+inline Uint32 readInput() {
+    const Uint8* ks = SDL_GetKeyboardState(NULL);
+    Uint32 input = 0;
+    if (ks[SDL_SCANCODE_LEFT]) input |= INPUT_LEFT;
+    if (ks[SDL_SCANCODE_RIGHT]) input |= INPUT_RIGHT;
+    return input;
+}
+
+inline void applyInput(ECS &ecs, Uint32 input) {
+    for (auto& paddle : ecs.paddles) {
+        ecs.velocities[paddle.first].vx = 0.0f;
+        Uint32 buttons = input >> (INPUT_BITS * paddle.second.player);
+
+        if (buttons & INPUT_LEFT) {
+            ecs.velocities[paddle.first].vx = -PADDLE_SPEED;
+        }
+        if (buttons & INPUT_RIGHT) {
+            ecs.velocities[paddle.first].vx = PADDLE_SPEED;
+        }
+    }
+}
+
+// Piloto automático: sigo la pelota con el paddle del jugador, para corridas
+// sin teclado. Devuelve los botones ya corridos para ese jugador.
+inline Uint32 autopilotInput(ECS &ecs, int player = 0) {
+    if (ecs.balls.empty()) return 0;
+    for (const auto& p : ecs.paddles) {
+        if (p.second.player != player) continue;
+        const Position& ball = ecs.positions[ecs.balls.begin()->first];
+        const Position& paddle = ecs.positions[p.first];
+        float target = ball.x + BALL_SIZE / 2.0f;
+        float center = paddle.x + PADDLE_WIDTH / 2.0f;
+        if (target < center - PADDLE_WIDTH / 4.0f) return playerInput(INPUT_LEFT, player);
+        if (target > center + PADDLE_WIDTH / 4.0f) return playerInput(INPUT_RIGHT, player);
+        return 0;
+    }
+    return 0;
+}
+
+// Manejo de la entrada
+// Devuelve la entrada aplicada, que queda vigente hasta el próximo evento
+inline Uint32 handleInput(ECS &ecs, SDL_Event& e) {
+    PROFILE_ZONE("handleInput");
+    PERF_ZONE("handleInput", ecs.paddles.size());
+    Uint32 input = readInput();
+    applyInput(ecs, input);
+    return input;
+}
+
+// Verifico colisiones
+inline bool checkCollision(Position& aPos, Position& bPos, int bWidth, int bHeight) {
+    return aPos.x < bPos.x + bWidth && aPos.x + BALL_SIZE > bPos.x && aPos.y < bPos.y + bHeight && aPos.y + BALL_SIZE > bPos.y;
+}
+
+// Estado de la partida después de un update; quien llama decide qué hacer al
+// terminar. En versus Won quiere decir que terminó el partido (sin bloques o
+// con alguien en VERSUS_POINTS); quién ganó se ve en los tantos de los paddles.
+enum class GameStatus { Running, GameOver, Won };
+
+// El paddle de un jugador, o -1
+inline int findPaddle(const ECS &ecs, int player) {
+    for (const auto& p : ecs.paddles) {
+        if (p.second.player == player) return p.first;
+    }
+    return -1;
+}
+
+// Paddles de un mundo que viene de afuera (archivo, foto, replay): cada uno es
+// del jugador 0 o 1 y no hay dos del mismo. applyInput() corre la entrada
+// 2 * player bits y findPaddle() tiene que encontrar a cada jugador una vez.
+template <typename It>
+inline bool validPaddlePlayers(It first, It last) {
+    bool seen[2] = { false, false };
+    for (; first != last; ++first) {
+        int player = first->second.player;
+        if (player < 0 || player > 1 || seen[player]) return false;
+        seen[player] = true;
+    }
+    return true;
+}
+
+// Tanto en versus: suma el otro jugador y saco hacia el que perdió el tanto
+inline bool scorePoint(ECS &ecs, int loser, Position& pos, Velocity& vel) {
+    int winner = findPaddle(ecs, 1 - loser);
+    Paddle& paddle = ecs.paddles[winner];
+    ++paddle.points;
+    pos.x = SCREEN_WIDTH / 2.0f;
+    pos.y = loser == 0 ? SCREEN_HEIGHT * 0.75f : SCREEN_HEIGHT * 0.25f - BALL_SIZE;
+    vel.vy = loser == 0 ? BALL_SPEED : -BALL_SPEED;
+    return paddle.points >= VERSUS_POINTS;
+}
+
+// Actualizo el estado del juego
+inline GameStatus update(ECS &ecs, float dT) {
+    PROFILE_ZONE("update");
+    PERF_ZONE("update", ecs.positions.size());
+    ecs.events.clear();
+    const Camera camera = mainCamera(ecs);
+    std::vector<int>& nearby = ecs.nearbyBlocks;
+    const bool versus = findPaddle(ecs, 1) >= 0; // con paddle arriba el techo es un arco
+
+    {
+        PROFILE_ZONE("update.paddles");
+        for (auto& paddle : ecs.paddles) {
+            auto& pos = ecs.positions[paddle.first];
+            auto& vel = ecs.velocities[paddle.first];
+
+            pos.x += vel.vx * dT;
+            if (pos.x < 0) pos.x = 0;
+            if (pos.x + PADDLE_WIDTH > SCREEN_WIDTH) pos.x = SCREEN_WIDTH - PADDLE_WIDTH;
+        }
+    }
+
+    {
+        PROFILE_ZONE("update.balls");
+        for (auto& ball : ecs.balls) {
+            auto& pos = ecs.positions[ball.first];
+            auto& vel = ecs.velocities[ball.first];
+            if (!isAwake(camera, pos)) continue;
+
+            pos.x += vel.vx * dT;
+            pos.y += vel.vy * dT;
+
+            if (pos.x < 0 || pos.x + BALL_SIZE > SCREEN_WIDTH) {
+                vel.vx *= -1;
+            }
+            if (pos.y < 0) {
+                if (versus) {
+                    if (scorePoint(ecs, 1, pos, vel)) return GameStatus::Won;
+                    continue;
+                }
+                vel.vy *= -1;
+            }
+            if (pos.y + BALL_SIZE > ecs.worldHeight) {
+                if (!versus) return GameStatus::GameOver;
+                if (scorePoint(ecs, 0, pos, vel)) return GameStatus::Won;
+                continue;
+            }
+
+            for (auto& paddle : ecs.paddles) {
+                if (checkCollision(pos, ecs.positions[paddle.first], PADDLE_WIDTH, PADDLE_HEIGHT)) {
+                    vel.vy *= -1;
+                    // El de abajo la devuelve hacia arriba y el de arriba hacia abajo
+                    pos.y = paddle.second.player == 0 ? ecs.positions[paddle.first].y - BALL_SIZE
+                                                      : ecs.positions[paddle.first].y + PADDLE_HEIGHT;
+                }
+            }
+
+            // Solo los bloques de las celdas que toca la pelota
+            PROFILE_ZONE("update.blocks");
+            nearby.clear();
+            ecs.blockGrid.query(pos.x, pos.y, BALL_SIZE, BALL_SIZE, nearby);
+            for (int id : nearby) {
+                Block& block = ecs.blocks[id];
+                Position& blockPos = ecs.positions[id];
+                if (block.active && checkCollision(pos, blockPos, BLOCK_WIDTH, BLOCK_HEIGHT)) {
+                    vel.vy *= -1;
+                    block.active = false;
+                    ecs.blockGrid.remove(id, blockPos.x, blockPos.y, BLOCK_WIDTH, BLOCK_HEIGHT);
+                    --ecs.blocksLeft;
+                    ecs.score += 10;
+                    ecs.events.push_back({ blockPos.x + BLOCK_WIDTH / 2.0f, blockPos.y + BLOCK_HEIGHT / 2.0f, ecs.colors[id].color });
+                }
+            }
+
+            if (ecs.blocksLeft == 0) {
+                return GameStatus::Won;
+            }
+        }
+    }
+
+    PROFILE_ZONE("update.camera");
+    updateCamera(ecs);
+    return GameStatus::Running;
+}
+
+// Cota de lo que puede entrar en pantalla, para reservar la foto de una vez
+inline size_t maxVisibleItems(ECS &ecs) {
+    return BLOCK_COLUMNS * (SCREEN_HEIGHT / (BLOCK_HEIGHT + 10) + 2) + ecs.paddles.size() + ecs.balls.size();
+}
+
+inline bool inView(const Camera& camera, const Position& pos, int w, int h) {
+    return pos.x < camera.x + camera.w && pos.x + w > camera.x && pos.y < camera.y + camera.h && pos.y + h > camera.y;
+}
+
+// Copio a la foto que consume el render lo que ve la cámara, ya en
+// coordenadas de pantalla. Los bloques salen de la grilla, así el costo
+// depende de lo visible y no del tamaño del nivel.
+// Con keepEvents se conservan los eventos de una foto que el render nunca leyó.
+inline void buildSnapshot(ECS &ecs, RenderSnapshot& snapshot, bool keepEvents = false) {
+    PROFILE_ZONE("snapshot");
+    const Camera camera = mainCamera(ecs);
+    snapshot.items.clear();
+    if (!keepEvents) snapshot.events.clear();
+    if (snapshot.events.capacity() < 64) snapshot.events.reserve(64);
+    if (snapshot.items.capacity() < maxVisibleItems(ecs)) snapshot.items.reserve(maxVisibleItems(ecs));
+    for (const auto& e : ecs.events) {
+        snapshot.events.push_back({ e.x - camera.x, e.y - camera.y, e.color });
+    }
+    snapshot.score = ecs.score;
+    snapshot.blocksLeft = ecs.blocksLeft;
+
+    for (const auto& paddle : ecs.paddles) {
+        auto& pos = ecs.positions[paddle.first];
+        if (!inView(camera, pos, PADDLE_WIDTH, PADDLE_HEIGHT)) continue;
+        snapshot.items.push_back({ pos.x - camera.x, pos.y - camera.y, PADDLE_WIDTH, PADDLE_HEIGHT, ecs.colors[paddle.first].color, ecs.sprites[paddle.first].id, LAYER_PADDLES, true });
+    }
+
+    for (const auto& ball : ecs.balls) {
+        auto& pos = ecs.positions[ball.first];
+        if (!inView(camera, pos, BALL_SIZE, BALL_SIZE)) continue;
+        snapshot.items.push_back({ pos.x - camera.x, pos.y - camera.y, BALL_SIZE, BALL_SIZE, ecs.colors[ball.first].color, ecs.sprites[ball.first].id, LAYER_BALLS, true });
+    }
+
+    std::vector<int>& visible = ecs.nearbyBlocks;
+    visible.clear();
+    ecs.blockGrid.query(camera.x, camera.y, static_cast<float>(camera.w), static_cast<float>(camera.h), visible);
+    for (int id : visible) {
+        auto& pos = ecs.positions[id];
+        if (!inView(camera, pos, BLOCK_WIDTH, BLOCK_HEIGHT)) continue;
+        snapshot.items.push_back({ pos.x - camera.x, pos.y - camera.y, BLOCK_WIDTH, BLOCK_HEIGHT, ecs.colors[id].color, ecs.sprites[id].id, LAYER_BLOCKS, true });
+    }
+}
+
+// Estado del render entre frames
+struct RenderContext {
+    SDL_Renderer* renderer = nullptr;
+    WorkerPool* pool = nullptr;           // workers para grabar comandos y rasterizar tiles
+    RenderCommandList commands;
+    TileRenderer* tiles = nullptr;        // nullptr: dibujo directo con SDL
+    SDL_Texture* tileTexture = nullptr;   // textura streaming donde subo el framebuffer de tiles
+    TextureAtlas* atlas = nullptr;        // nullptr: rectángulos sólidos con SDL_RenderFillRect
+    SpriteBatch batch;
+    ParticleSystem* particles = nullptr;  // efectos al romper bloques
+    Hud* hud = nullptr;                   // se dibuja encima de todo
+};
+
+const int PARTICLES_PER_BLOCK = 96;
+const int MAX_PARTICLES = 1 << 16;
+
+// Emito las partículas de los bloques rotos en la foto y las avanzo
+inline void updateParticles(ParticleSystem& particles, const RenderSnapshot& snapshot, float dT) {
+    PROFILE_ZONE("particles.update");
+    for (const auto& e : snapshot.events) {
+        particles.emit(e.x, e.y, PARTICLES_PER_BLOCK, e.color);
+    }
+    particles.update(dT);
+}
+
+// FPS y tiempo de frame promedio, recalculados una vez por segundo
+struct FpsCounter {
+    Uint32 windowStart = 0;
+    int frames = 0;
+    float fps = 0.0f;
+    float frameMs = 0.0f;
+
+    void frame(Uint32 now) {
+        ++frames;
+        Uint32 elapsed = now - windowStart;
+        if (elapsed > 1000) {
+            fps = frames * 1000.0f / elapsed;
+            frameMs = static_cast<float>(elapsed) / frames;
+            frames = 0;
+            windowStart = now;
+        }
+    }
+};
+
+inline void updateHud(Hud& hud, const RenderSnapshot& snapshot, const FpsCounter& fps) {
+    HudStats stats = { fps.fps, fps.frameMs, static_cast<int>(snapshot.items.size()), snapshot.blocksLeft, snapshot.score };
+    hud.update(stats);
+}
+
+// Renderizo el juego a partir de una foto del ECS (sin presentar, para poder leer el frame antes)
+inline void render(const RenderSnapshot& snapshot, RenderContext& ctx) {
+    PROFILE_ZONE("render");
+    PERF_ZONE("render", snapshot.items.size());
+    const SDL_Color background = { 0x00, 0x00, 0x00, 0xFF };
+    {
+        PROFILE_ZONE("render.record");
+        ctx.commands.reserve(snapshot.items.capacity());
+        buildRenderCommands(snapshot, ctx.commands, ctx.pool);
+    }
+
+    // Un solo hilo reproduce la lista ya ordenada contra SDL
+    PROFILE_ZONE("render.draw");
+    if (ctx.tiles) {
+        ctx.tiles->render(ctx.commands.data(), ctx.commands.size(), background);
+        SDL_UpdateTexture(ctx.tileTexture, NULL, ctx.tiles->pixels(), ctx.tiles->pitch());
+        SDL_RenderCopy(ctx.renderer, ctx.tileTexture, NULL, NULL);
+    } else if (ctx.atlas) {
+        // Sprites y rectángulos sólidos en una sola llamada de dibujo
+        SDL_SetRenderDrawColor(ctx.renderer, background.r, background.g, background.b, background.a);
+        SDL_RenderClear(ctx.renderer);
+        ctx.batch.begin();
+        ctx.batch.add(*ctx.atlas, ctx.commands.data(), ctx.commands.size());
+        ctx.batch.draw(ctx.renderer, *ctx.atlas);
+    } else {
+        SDL_SetRenderDrawColor(ctx.renderer, background.r, background.g, background.b, background.a);
+        SDL_RenderClear(ctx.renderer);
+        for (const auto& cmd : ctx.commands) {
+            SDL_SetRenderDrawColor(ctx.renderer, cmd.color.r, cmd.color.g, cmd.color.b, cmd.color.a);
+            SDL_RenderFillRect(ctx.renderer, &cmd.rect);
+        }
+    }
+
+    if (ctx.particles) {
+        PROFILE_ZONE("render.particles");
+        ctx.particles->draw(ctx.renderer);
+    }
+    if (ctx.hud) {
+        PROFILE_ZONE("render.hud");
+        ctx.hud->draw(ctx.renderer);
+    }
+}
+
+// Armo el atlas con los sprites del juego; si falla dibujo rectángulos sólidos
+inline TextureAtlas* createAtlas(SDL_Renderer* renderer) {
+    TextureAtlas* atlas = new TextureAtlas();
+    loadSprites(*atlas, PADDLE_WIDTH, PADDLE_HEIGHT, BALL_SIZE, BLOCK_WIDTH, BLOCK_HEIGHT);
+    if (!atlas->build(renderer)) {
+        std::cout << "No pude crear el atlas de sprites: " << SDL_GetError() << std::endl;
+        delete atlas;
+        return nullptr;
+    }
+    return atlas;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef BREAKOUT_API_H
+#define BREAKOUT_API_H
+
+/* API en C de la simulación (libbreakout.so / breakout.dll), para manejar
+ * mundos desde otros lenguajes sin abrir ventana ni inicializar el video de
+ * SDL. Un mundo es una partida: se crea, se avanza de a ticks, se reinicia,
+ * se clona y se destruye. El estado se lee con vistas que apuntan directo a
+ * los componentes del mundo, sin copiar.
+ *
+ * Las funciones de un mismo mundo no se pueden llamar desde dos hilos a la
+ * vez; mundos distintos sí, salvo create/reset, que usan rand() para los
+ * colores de los bloques. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#ifdef BREAKOUT_BUILD_LIBRARY
+#define BREAKOUT_API __declspec(dllexport)
+#else
+#define BREAKOUT_API __declspec(dllimport)
+#endif
+#else
+#define BREAKOUT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Cambia si cambia alguna firma o el formato de las vistas */
+#define BREAKOUT_ABI_VERSION 2
+
+typedef struct BreakoutWorld BreakoutWorld;
+
+/* Botones, como en el juego */
+enum { BREAKOUT_INPUT_LEFT = 1, BREAKOUT_INPUT_RIGHT = 2 };
+
+/* Estado de la partida después de un tick */
+enum { BREAKOUT_RUNNING = 0, BREAKOUT_GAME_OVER = 1, BREAKOUT_WON = 2 };
+
+/* Componentes que se pueden ver. Cada elemento es:
+ *   POSITIONS  { float x, y; }   esquina superior izquierda, en píxeles del nivel
+ *   VELOCITIES { float vx, vy; } píxeles por segundo
+ *   BLOCKS     { uint8_t active; }
+ *   PADDLES    { int32_t player, points; } jugador (0 abajo, 1 arriba) y tantos en versus
+ *   BALLS: sin datos, solo los ids */
+enum BreakoutComponent {
+    BREAKOUT_POSITIONS = 0,
+    BREAKOUT_VELOCITIES = 1,
+    BREAKOUT_BLOCKS = 2,
+    BREAKOUT_PADDLES = 3,
+    BREAKOUT_BALLS = 4
+};
+
+/* Vista sin copia de un componente: el elemento i está en
+ * (const char*)data + i * stride y su entidad en
+ * *(const int32_t*)((const char*)ids + i * stride). Vale hasta el próximo
+ * reset, load o destroy del mundo (load reemplaza los arreglos y puede
+ * moverlos); step no la invalida. */
+typedef struct BreakoutView {
+    const void* data;
+    const int32_t* ids;
+    int32_t count;
+    int32_t stride;
+} BreakoutView;
+
+BREAKOUT_API int breakout_abi_version(void);
+
+/* Nivel de levelScreens pantallas de alto; seed es la semilla de los colores */
+BREAKOUT_API BreakoutWorld* breakout_create(int levelScreens, uint32_t seed);
+BREAKOUT_API void breakout_destroy(BreakoutWorld* world);
+BREAKOUT_API void breakout_reset(BreakoutWorld* world);
+BREAKOUT_API BreakoutWorld* breakout_clone(const BreakoutWorld* world);
+
+/* Foto del mundo entero en buffer (alineado a 8 bytes, como lo que devuelve
+ * malloc), para volver atrás o probar jugadas. Devuelve cuántos bytes ocupa;
+ * si capacity no alcanza no escribe nada. */
+BREAKOUT_API size_t breakout_save(const BreakoutWorld* world, void* buffer, size_t capacity);
+
+/* Restaura una foto de breakout_save hecha con esta misma biblioteca; 1 si se
+ * pudo. Invalida las vistas de breakout_view del mundo. */
+BREAKOUT_API int breakout_load(BreakoutWorld* world, const void* buffer, size_t size);
+
+/* Un tick de dt segundos con los botones dados; devuelve BREAKOUT_RUNNING,
+ * BREAKOUT_GAME_OVER o BREAKOUT_WON */
+BREAKOUT_API int breakout_step(BreakoutWorld* world, uint32_t input, float dt);
+
+/* Hasta ticks ticks con inputs[i] en el tick i (NULL: piloto automático);
+ * corta al terminar la partida. Devuelve el estado y en *ticksRun cuántos corrió. */
+BREAKOUT_API int breakout_run(BreakoutWorld* world, const uint32_t* inputs, int ticks, float dt, int* ticksRun);
+
+BREAKOUT_API int breakout_score(const BreakoutWorld* world);
+BREAKOUT_API int breakout_blocks_left(const BreakoutWorld* world);
+BREAKOUT_API int breakout_world_height(const BreakoutWorld* world);
+BREAKOUT_API BreakoutView breakout_view(const BreakoutWorld* world, int component);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
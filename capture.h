@@ -0,0 +1,296 @@
+#ifndef BREAKOUT_CAPTURE_H
+#define BREAKOUT_CAPTURE_H
+
+#include "inc/SDL.h"
+#include "allocation.h"
+#include "varint.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Formato de captura: cabecera "BKCAP1" + ancho y alto, y por frame
+// (índice, bytes, payload). El payload son operaciones varint
+// (cantidad << 2 | op) contra el frame anterior:
+//   CAPTURE_SKIP    pixels iguales al frame anterior
+//   CAPTURE_FILL    un pixel repetido, seguido del pixel (4 bytes)
+//   CAPTURE_LITERAL pixels copiados tal cual
+enum { CAPTURE_SKIP = 0, CAPTURE_FILL = 1, CAPTURE_LITERAL = 2 };
+const char CAPTURE_MAGIC[8] = { 'B', 'K', 'C', 'A', 'P', '1', 0, 0 };
+
+// Codifico frame contra previous (mismo tamaño)
+inline void encodeCaptureFrame(const Uint32* frame, const Uint32* previous, size_t count, std::vector<Uint8>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < count) {
+        size_t run = i;
+        while (run < count && frame[run] == previous[run]) ++run;
+        if (run > i) {
+            appendVarint(out, (static_cast<Uint64>(run - i) << 2) | CAPTURE_SKIP);
+            i = run;
+            continue;
+        }
+
+        run = i + 1;
+        while (run < count && frame[run] == frame[i]) ++run;
+        if (run - i >= 4) {
+            appendVarint(out, (static_cast<Uint64>(run - i) << 2) | CAPTURE_FILL);
+            const Uint8* p = reinterpret_cast<const Uint8*>(&frame[i]);
+            out.insert(out.end(), p, p + sizeof(Uint32));
+            i = run;
+            continue;
+        }
+
+        // Literal hasta el próximo pixel sin cambios o la próxima racha larga
+        run = i + 1;
+        while (run < count && frame[run] != previous[run] &&
+               !(run + 3 < count && frame[run] == frame[run + 1] && frame[run] == frame[run + 2] && frame[run] == frame[run + 3])) {
+            ++run;
+        }
+        appendVarint(out, (static_cast<Uint64>(run - i) << 2) | CAPTURE_LITERAL);
+        const Uint8* p = reinterpret_cast<const Uint8*>(&frame[i]);
+        out.insert(out.end(), p, p + (run - i) * sizeof(Uint32));
+        i = run;
+    }
+}
+
+// Aplico un payload sobre frame, que tiene el frame anterior
+inline bool decodeCaptureFrame(const Uint8* in, size_t size, Uint32* frame, size_t count) {
+    const Uint8* end = in + size;
+    size_t i = 0;
+    while (in < end) {
+        Uint64 header;
+        if (!readVarint(in, end, header)) return false;
+        size_t n = static_cast<size_t>(header >> 2);
+        if (i + n > count) return false;
+
+        switch (header & 3) {
+        case CAPTURE_SKIP:
+            break;
+        case CAPTURE_FILL: {
+            if (end - in < 4) return false;
+            Uint32 pixel;
+            memcpy(&pixel, in, sizeof(pixel));
+            in += sizeof(pixel);
+            for (size_t k = 0; k < n; ++k) frame[i + k] = pixel;
+            break;
+        }
+        case CAPTURE_LITERAL:
+            if (static_cast<size_t>(end - in) < n * sizeof(Uint32)) return false;
+            memcpy(&frame[i], in, n * sizeof(Uint32));
+            in += n * sizeof(Uint32);
+            break;
+        default:
+            return false;
+        }
+        i += n;
+    }
+    return i == count;
+}
+
+// Cola SPSC de índices de buffer. Nunca se llena: hay más lugares que buffers.
+struct IndexRing {
+    std::vector<int> slots;
+    SDL_atomic_t head, tail;
+
+    explicit IndexRing(int capacity) : slots(capacity + 1) {
+        SDL_AtomicSet(&head, 0);
+        SDL_AtomicSet(&tail, 0);
+    }
+
+    void push(int value) {
+        int t = SDL_AtomicGet(&tail);
+        slots[t] = value;
+        SDL_AtomicSet(&tail, (t + 1) % static_cast<int>(slots.size()));
+    }
+
+    bool pop(int& value) {
+        int h = SDL_AtomicGet(&head);
+        if (h == SDL_AtomicGet(&tail)) return false;
+        value = slots[h];
+        SDL_AtomicSet(&head, (h + 1) % static_cast<int>(slots.size()));
+        return true;
+    }
+};
+
+// Captura asíncrona: el render copia el frame a un buffer libre del pool y se
+// lo pasa a un hilo que codifica y escribe con SDL_RWops. Si no hay buffer
+// libre el frame se descarta, render() nunca espera al escritor.
+class FrameCapture {
+public:
+    FrameCapture(const char* path, int width, int height, int poolSize = 4)
+        : width(width), height(height), pixelCount(static_cast<size_t>(width) * height),
+          buffers(poolSize, std::vector<Uint32>(static_cast<size_t>(width) * height)),
+          frameIndices(poolSize), freeRing(poolSize), fullRing(poolSize),
+          previous(static_cast<size_t>(width) * height, 0),
+          nextFrame(0), captured(0), dropped(0), rawBytes(0), encodedBytes(0), encodeTicks(0) {
+        SDL_AtomicSet(&quit, 0);
+        for (int i = 0; i < poolSize; ++i) freeRing.push(i);
+
+        file = SDL_RWFromFile(path, "wb");
+        if (file) {
+            SDL_RWwrite(file, CAPTURE_MAGIC, 1, sizeof(CAPTURE_MAGIC));
+            SDL_WriteLE32(file, width);
+            SDL_WriteLE32(file, height);
+        }
+        pending = SDL_CreateSemaphore(0);
+        thread = SDL_CreateThread(writerMain, "capture", this);
+    }
+
+    ~FrameCapture() {
+        finish();
+        SDL_DestroySemaphore(pending);
+    }
+
+    // Escribo lo pendiente, termino el hilo y cierro el archivo
+    void finish() {
+        if (!thread) return;
+        SDL_AtomicSet(&quit, 1);
+        SDL_SemPost(pending);
+        SDL_WaitThread(thread, NULL);
+        thread = nullptr;
+        if (file) SDL_RWclose(file);
+        file = nullptr;
+    }
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    bool ok() const { return file != nullptr; }
+
+    Uint32 droppedFrames() const { return dropped; }
+
+    // Después de dibujar y antes de SDL_RenderPresent
+    void capture(SDL_Renderer* renderer) {
+        int buffer = acquire();
+        if (buffer < 0) return;
+        SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, buffers[buffer].data(), width * static_cast<int>(sizeof(Uint32)));
+        submit(buffer);
+    }
+
+    // Para el rasterizador por tiles, el frame ya está en memoria
+    void capture(const Uint32* pixels) {
+        int buffer = acquire();
+        if (buffer < 0) return;
+        memcpy(buffers[buffer].data(), pixels, pixelCount * sizeof(Uint32));
+        submit(buffer);
+    }
+
+    void printStats() const {
+        double seconds = encodeTicks / static_cast<double>(SDL_GetPerformanceFrequency());
+        double rawMB = rawBytes / (1024.0 * 1024.0);
+        double encodedMB = encodedBytes / (1024.0 * 1024.0);
+        printf("Captura: %u frames escritos, %u descartados, %.1f MB -> %.2f MB (%.1fx), codificando a %.1f MB/s\n",
+               captured, dropped, rawMB, encodedMB, encodedMB > 0 ? rawMB / encodedMB : 0.0, seconds > 0 ? rawMB / seconds : 0.0);
+    }
+
+private:
+    int acquire() {
+        int buffer;
+        Uint32 frame = nextFrame++;
+        if (!file || !freeRing.pop(buffer)) {
+            ++dropped;
+            return -1;
+        }
+        frameIndices[buffer] = frame;
+        return buffer;
+    }
+
+    void submit(int buffer) {
+        fullRing.push(buffer);
+        SDL_SemPost(pending);
+    }
+
+    static int SDLCALL writerMain(void* data) {
+        static_cast<FrameCapture*>(data)->writerLoop();
+        return 0;
+    }
+
+    void writerLoop() {
+        ignoreThreadAllocations();
+        std::vector<Uint8> encoded;
+        encoded.reserve(pixelCount);
+        for (;;) {
+            SDL_SemWait(pending);
+            int buffer;
+            if (!fullRing.pop(buffer)) {
+                if (SDL_AtomicGet(&quit)) return;
+                continue;
+            }
+
+            Uint64 start = SDL_GetPerformanceCounter();
+            encodeCaptureFrame(buffers[buffer].data(), previous.data(), pixelCount, encoded);
+            SDL_WriteLE32(file, frameIndices[buffer]);
+            SDL_WriteLE32(file, static_cast<Uint32>(encoded.size()));
+            SDL_RWwrite(file, encoded.data(), 1, encoded.size());
+            encodeTicks += SDL_GetPerformanceCounter() - start;
+
+            ++captured;
+            rawBytes += pixelCount * sizeof(Uint32);
+            encodedBytes += encoded.size();
+
+            // El frame recién escrito pasa a ser la referencia y el buffer
+            // anterior vuelve al pool, sin copiar pixels
+            previous.swap(buffers[buffer]);
+            freeRing.push(buffer);
+        }
+    }
+
+    int width, height;
+    size_t pixelCount;
+    std::vector<std::vector<Uint32>> buffers;
+    std::vector<Uint32> frameIndices;
+    IndexRing freeRing;  // buffers que puede usar el render
+    IndexRing fullRing;  // frames esperando al escritor
+    std::vector<Uint32> previous; // solo lo toca el escritor
+    SDL_RWops* file;
+    SDL_sem* pending;
+    SDL_Thread* thread;
+    SDL_atomic_t quit;
+
+    Uint32 nextFrame;
+    Uint32 captured, dropped;
+    Uint64 rawBytes, encodedBytes, encodeTicks;
+};
+
+// Exporto una captura como BMPs numerados en dir
+inline int exportCapture(const char* path, const char* dir) {
+    SDL_RWops* file = SDL_RWFromFile(path, "rb");
+    if (!file) return 1;
+
+    char magic[sizeof(CAPTURE_MAGIC)];
+    if (SDL_RWread(file, magic, 1, sizeof(magic)) != sizeof(magic) || memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) != 0) {
+        SDL_RWclose(file);
+        return 1;
+    }
+    int width = static_cast<int>(SDL_ReadLE32(file));
+    int height = static_cast<int>(SDL_ReadLE32(file));
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    std::vector<Uint32> frame(static_cast<size_t>(width) * height, 0);
+    std::vector<Uint8> payload;
+
+    int exported = 0;
+    for (;;) {
+        Uint32 index = SDL_ReadLE32(file);
+        Uint32 size = SDL_ReadLE32(file);
+        payload.resize(size);
+        if (size == 0 || SDL_RWread(file, payload.data(), 1, size) != size) break;
+        if (!decodeCaptureFrame(payload.data(), size, frame.data(), frame.size())) break;
+
+        for (int y = 0; y < height; ++y) {
+            memcpy(static_cast<Uint8*>(surface->pixels) + y * surface->pitch, &frame[static_cast<size_t>(y) * width], width * sizeof(Uint32));
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "/capture_%06u.bmp", index);
+        SDL_SaveBMP(surface, (std::string(dir) + name).c_str());
+        ++exported;
+    }
+
+    printf("%d frames exportados a %s\n", exported, dir);
+    SDL_FreeSurface(surface);
+    SDL_RWclose(file);
+    return exported > 0 ? 0 : 1;
+}
+
+#endif
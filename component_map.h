@@ -0,0 +1,86 @@
+#ifndef BREAKOUT_COMPONENT_MAP_H
+#define BREAKOUT_COMPONENT_MAP_H
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Componentes de un tipo guardados de forma contigua (sparse set): dense
+// tiene los pares (entidad, componente) uno detrás del otro y sparse dice en
+// qué posición de dense está cada entidad. Se usa como el unordered_map de
+// antes (operator[] crea el componente si no existe, se itera por .first y
+// .second) pero recorrerlo es leer memoria seguida y los datos se pueden
+// exponer sin copiar, con un paso de sizeof(value_type) entre elementos.
+// Los ids tienen que ser chicos y densos: cada ECS numera sus entidades desde 0.
+template <typename T>
+class ComponentMap {
+public:
+    typedef std::pair<int, T> value_type;
+    typedef typename std::vector<value_type>::iterator iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+    T& operator[](int id) {
+        if (static_cast<size_t>(id) >= sparse.size()) sparse.resize(id + 1, -1);
+        if (sparse[id] < 0) {
+            sparse[id] = static_cast<int>(dense.size());
+            dense.push_back(value_type(id, T()));
+        }
+        return dense[sparse[id]].second;
+    }
+
+    bool contains(int id) const {
+        return static_cast<size_t>(id) < sparse.size() && sparse[id] >= 0;
+    }
+
+    // El último ocupa el lugar del borrado: el orden de iteración cambia
+    void erase(int id) {
+        if (!contains(id)) return;
+        int index = sparse[id];
+        if (static_cast<size_t>(index) + 1 != dense.size()) {
+            dense[index] = dense.back();
+            sparse[dense[index].first] = index;
+        }
+        dense.pop_back();
+        sparse[id] = -1;
+    }
+
+    void reserve(size_t count) { dense.reserve(count); }
+
+    void clear() {
+        dense.clear();
+        sparse.clear();
+    }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+    iterator begin() { return dense.begin(); }
+    iterator end() { return dense.end(); }
+    const_iterator begin() const { return dense.begin(); }
+    const_iterator end() const { return dense.end(); }
+
+    // Arreglo de pares para vistas sin copia; válido hasta que se agregue o borre un componente
+    const value_type* data() const { return dense.data(); }
+
+    // Índice crudo (posición en dense por entidad), para copiar el mapa entero
+    const int* indexData() const { return sparse.data(); }
+    size_t indexSize() const { return sparse.size(); }
+
+    // Reemplazo el contenido con memcpy de arreglos guardados con data() e
+    // indexData(); si ya hay capacidad no asigna memoria
+    void assignRaw(const value_type* items, size_t count, const int* index, size_t indexCount) {
+        static_assert(std::is_trivially_copyable<T>::value, "los componentes se copian con memcpy");
+        dense.resize(count);
+        if (count) memcpy(static_cast<void*>(dense.data()), items, count * sizeof(value_type));
+        sparse.resize(indexCount);
+        if (indexCount) memcpy(sparse.data(), index, indexCount * sizeof(int));
+    }
+
+private:
+    std::vector<value_type> dense;
+    std::vector<int> sparse; // -1: la entidad no tiene este componente
+};
+
+#endif
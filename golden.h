@@ -0,0 +1,124 @@
+#ifndef BREAKOUT_GOLDEN_H
+#define BREAKOUT_GOLDEN_H
+
+#include "inc/SDL.h"
+#include "inc/SDL_test_compare.h"
+#include "inc/SDL_test_crc32.h"
+#include "inc/SDL_test_md5.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Hash de un frame: CRC32 para comparar rápido y MD5 por si hay colisiones
+struct FrameHash {
+    Uint32 crc32;
+    unsigned char md5[16];
+
+    bool operator==(const FrameHash& other) const {
+        return crc32 == other.crc32 && memcmp(md5, other.md5, sizeof(md5)) == 0;
+    }
+    bool operator!=(const FrameHash& other) const { return !(*this == other); }
+};
+
+// Leo el frame actual con SDL_RenderReadPixels a un buffer reutilizado y lo hasheo
+class FrameHasher {
+public:
+    FrameHasher(int width, int height) : width(width), height(height), pixels(static_cast<size_t>(width) * height) {
+        SDLTest_Crc32Init(&crcContext);
+    }
+
+    ~FrameHasher() { SDLTest_Crc32Done(&crcContext); }
+
+    // Llamar después de dibujar y antes de SDL_RenderPresent
+    bool capture(SDL_Renderer* renderer) {
+        return SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, pixels.data(), pitch()) == 0;
+    }
+
+    FrameHash hash() {
+        FrameHash h;
+        unsigned char* bytes = reinterpret_cast<unsigned char*>(pixels.data());
+        Uint32 size = static_cast<Uint32>(pixels.size() * sizeof(Uint32));
+        SDLTest_Crc32Calc(&crcContext, bytes, size, &h.crc32);
+
+        SDLTest_Md5Context md5;
+        SDLTest_Md5Init(&md5);
+        SDLTest_Md5Update(&md5, bytes, size);
+        SDLTest_Md5Final(&md5);
+        memcpy(h.md5, md5.digest, sizeof(h.md5));
+        return h;
+    }
+
+    // Surface que apunta al último frame leído, sin copiarlo
+    SDL_Surface* surface() {
+        return SDL_CreateRGBSurfaceWithFormatFrom(pixels.data(), width, height, 32, pitch(), SDL_PIXELFORMAT_ARGB8888);
+    }
+
+private:
+    int pitch() const { return width * static_cast<int>(sizeof(Uint32)); }
+
+    int width, height;
+    std::vector<Uint32> pixels;
+    SDLTest_Crc32Context crcContext;
+};
+
+// Log de hashes: una línea por frame "frame crc32 md5"
+inline void writeFrameHash(FILE* file, int frame, const FrameHash& h) {
+    char md5[33];
+    for (int i = 0; i < 16; ++i) snprintf(md5 + i * 2, 3, "%02x", h.md5[i]);
+    fprintf(file, "%d %08x %s\n", frame, static_cast<unsigned>(h.crc32), md5);
+}
+
+// Los frames van de 0 a maxFrames - 1 (los de la corrida); un log con un
+// frame más allá se rechaza, así un número roto no reserva gigas de memoria
+inline bool readGoldenLog(const char* path, std::vector<FrameHash>& hashes, int maxFrames) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    int frame;
+    unsigned crc;
+    char md5[33];
+    while (fscanf(file, "%d %x %32s", &frame, &crc, md5) == 3) {
+        if (frame < 0) continue;
+        if (frame >= maxFrames) {
+            fclose(file);
+            return false;
+        }
+        if (static_cast<size_t>(frame) >= hashes.size()) hashes.resize(static_cast<size_t>(frame) + 1);
+        FrameHash& h = hashes[frame];
+        h.crc32 = crc;
+        for (int i = 0; i < 16; ++i) {
+            unsigned byte = 0;
+            sscanf(md5 + i * 2, "%2x", &byte);
+            h.md5[i] = static_cast<unsigned char>(byte);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+inline std::string goldenFramePath(const char* dir, const char* prefix, int frame) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s_%06d.bmp", prefix, frame);
+    return std::string(dir) + "/" + name;
+}
+
+// Guardo el frame que no coincide y, si hay imagen de referencia, cuento los
+// pixels distintos con SDLTest_CompareSurfaces
+inline void dumpMismatch(FrameHasher& hasher, const char* dir, int frame) {
+    SDL_Surface* actual = hasher.surface();
+    std::string actualPath = goldenFramePath(dir, "mismatch", frame);
+    SDL_SaveBMP(actual, actualPath.c_str());
+
+    SDL_Surface* reference = SDL_LoadBMP(goldenFramePath(dir, "golden", frame).c_str());
+    if (reference) {
+        int differing = SDLTest_CompareSurfaces(actual, reference, 0);
+        printf("Frame %d: %d pixels distintos, guardado en %s\n", frame, differing, actualPath.c_str());
+        SDL_FreeSurface(reference);
+    } else {
+        printf("Frame %d: no coincide, guardado en %s (sin imagen de referencia)\n", frame, actualPath.c_str());
+    }
+    SDL_FreeSurface(actual);
+}
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef BREAKOUT_HEADLESS_H
+#define BREAKOUT_HEADLESS_H
+
+#include "inc/SDL.h"
+#include "breakout.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+inline const char* gameStatusName(GameStatus status) {
+    switch (status) {
+    case GameStatus::GameOver: return "game over";
+    case GameStatus::Won: return "gano";
+    default: return "en curso";
+    }
+}
+
+// Entrada guionada: tramos de "ticks botones", uno por renglón, donde botones
+// es L, R, LR o - (nada). Las líneas con # son comentarios. Al terminar el
+// guion vuelve a empezar.
+//
+//   120 R
+//   30 -
+//   200 L
+class InputScript {
+public:
+    bool load(const char* path) {
+        FILE* in = fopen(path, "r");
+        if (!in) return false;
+        steps.clear();
+        total = 0;
+        char line[128];
+        while (fgets(line, sizeof(line), in)) {
+            unsigned ticks;
+            char buttons[16];
+            if (line[0] == '#' || sscanf(line, "%u %15s", &ticks, buttons) != 2 || ticks == 0) continue;
+            Uint32 input = 0;
+            if (strchr(buttons, 'L')) input |= INPUT_LEFT;
+            if (strchr(buttons, 'R')) input |= INPUT_RIGHT;
+            steps.push_back({ ticks, input });
+            total += ticks;
+        }
+        fclose(in);
+        return !steps.empty();
+    }
+
+    // Botones del tick (cuenta desde 0)
+    Uint32 input(Uint64 tick) const {
+        if (steps.empty()) return 0;
+        Uint64 t = tick % total;
+        for (const auto& step : steps) {
+            if (t < step.ticks) return step.input;
+            t -= step.ticks;
+        }
+        return 0;
+    }
+
+private:
+    struct Step {
+        Uint32 ticks;
+        Uint32 input;
+    };
+    std::vector<Step> steps;
+    Uint64 total = 0;
+};
+
+// Cómo terminó una corrida sin ventana
+struct HeadlessResult {
+    GameStatus status;   // Running si se cumplieron los ticks sin terminar la partida
+    Uint64 ticks;
+    double seconds;
+    int score;
+    int blocksLeft;
+};
+
+// Avanzo la simulación lo más rápido posible, con dT fijo, hasta maxTicks o
+// hasta que la partida termine. Sin script juega el piloto automático.
+inline HeadlessResult runHeadless(ECS& ecs, Uint64 maxTicks, float dT, const InputScript* script) {
+    HeadlessResult result = { GameStatus::Running, 0, 0.0, 0, 0 };
+    Uint64 start = SDL_GetPerformanceCounter();
+    while (result.ticks < maxTicks) {
+        applyInput(ecs, script ? script->input(result.ticks) : autopilotInput(ecs));
+        result.status = update(ecs, dT);
+        ++result.ticks;
+        if (result.status != GameStatus::Running) break;
+    }
+    result.seconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+    result.score = ecs.score;
+    result.blocksLeft = ecs.blocksLeft;
+    return result;
+}
+
+// Varios mundos independientes, uno por hilo, para medir cuánto escala por
+// núcleo. Los mundos se crean antes en el hilo que llama (createEntity y
+// rand() no son seguros entre hilos); update() no comparte estado.
+struct HeadlessJob {
+    ECS* ecs;
+    Uint64 maxTicks;
+    float dT;
+    const InputScript* script;
+    HeadlessResult result;
+};
+
+inline int SDLCALL headlessMain(void* data) {
+    HeadlessJob& job = *static_cast<HeadlessJob*>(data);
+    job.result = runHeadless(*job.ecs, job.maxTicks, job.dT, job.script);
+    return 0;
+}
+
+inline void runHeadlessParallel(std::vector<HeadlessJob>& jobs) {
+    std::vector<SDL_Thread*> threads;
+    for (size_t i = 1; i < jobs.size(); ++i) threads.push_back(SDL_CreateThread(headlessMain, "headless", &jobs[i]));
+    if (!jobs.empty()) headlessMain(&jobs[0]);
+    for (SDL_Thread* thread : threads) SDL_WaitThread(thread, NULL);
+}
+
+#endif
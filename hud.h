@@ -0,0 +1,183 @@
+#ifndef BREAKOUT_HUD_H
+#define BREAKOUT_HUD_H
+
+#include "inc/SDL.h"
+#include "inc/SDL_test_font.h"
+#include "atlas.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+const int HUD_FIRST_CHAR = 32;
+const int HUD_LAST_CHAR = 126;
+const double HUD_BUDGET_US = 50.0;
+
+// Lo que muestra el HUD
+struct HudStats {
+    float fps;
+    float frameMs;
+    int entities;
+    int blocksLeft;
+    int score;
+};
+
+// HUD de texto: los glifos de SDL_test_font.h se rasterizan una sola vez en un
+// atlas, cada línea guarda su texto y solo se vuelve a armar la geometría
+// cuando algún texto cambia. Todo el HUD se dibuja con un SDL_RenderGeometry.
+class Hud {
+public:
+    Hud() : firstGlyph(0), dirty(true), costTicks(0), costMaxTicks(0), costFrames(0),
+            windowTicks(0), windowFrames(0), windowStart(0), lastCostUs(0.0), updateTicks(0) {}
+
+    bool init(SDL_Renderer* renderer) {
+        const int count = HUD_LAST_CHAR - HUD_FIRST_CHAR + 1;
+
+        // Dibujo todos los caracteres una vez en una tira con SDLTest_DrawString
+        SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, count * FONT_CHARACTER_SIZE, FONT_CHARACTER_SIZE, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!sheet) return false;
+        SDL_Renderer* sheetRenderer = SDL_CreateSoftwareRenderer(sheet);
+        if (!sheetRenderer) {
+            SDL_FreeSurface(sheet);
+            return false;
+        }
+        SDL_SetRenderDrawColor(sheetRenderer, 0, 0, 0, 0);
+        SDL_RenderClear(sheetRenderer);
+        SDL_SetRenderDrawColor(sheetRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
+        char chars[HUD_LAST_CHAR - HUD_FIRST_CHAR + 2];
+        for (int c = HUD_FIRST_CHAR; c <= HUD_LAST_CHAR; ++c) chars[c - HUD_FIRST_CHAR] = static_cast<char>(c);
+        chars[count] = '\0';
+        SDLTest_DrawString(sheetRenderer, 0, 0, chars);
+        SDLTest_CleanupTextDrawing();
+        SDL_DestroyRenderer(sheetRenderer);
+
+        for (int i = 0; i < count; ++i) {
+            SDL_Surface* glyph = SDL_CreateRGBSurfaceWithFormat(0, FONT_CHARACTER_SIZE, FONT_CHARACTER_SIZE, 32, SDL_PIXELFORMAT_ARGB8888);
+            if (!glyph) {
+                SDL_FreeSurface(sheet);
+                return false;
+            }
+            SDL_Rect src = { i * FONT_CHARACTER_SIZE, 0, FONT_CHARACTER_SIZE, FONT_CHARACTER_SIZE };
+            SDL_SetSurfaceBlendMode(sheet, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(sheet, &src, glyph, NULL);
+            Uint16 id = atlas.add("glyph", glyph);
+            if (i == 0) firstGlyph = id;
+        }
+        SDL_FreeSurface(sheet);
+        return atlas.build(renderer);
+    }
+
+    // Formateo las líneas; solo marcan la geometría como sucia si cambian
+    void update(const HudStats& stats) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        char text[64];
+        snprintf(text, sizeof(text), "FPS %.0f  %.2f ms", stats.fps, stats.frameMs);
+        setLine(0, text);
+        snprintf(text, sizeof(text), "Entidades %d  Bloques %d", stats.entities, stats.blocksLeft);
+        setLine(1, text);
+        snprintf(text, sizeof(text), "Puntos %d", stats.score);
+        setLine(2, text);
+        snprintf(text, sizeof(text), "HUD %.1f us", lastCostUs);
+        setLine(3, text);
+        updateTicks = SDL_GetPerformanceCounter() - start;
+    }
+
+    void draw(SDL_Renderer* renderer) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        if (dirty) rebuild();
+        if (!indices.empty()) {
+            SDL_RenderGeometry(renderer, atlas.getTexture(), vertices.data(), static_cast<int>(vertices.size()),
+                               indices.data(), static_cast<int>(indices.size()));
+        }
+        measure(SDL_GetPerformanceCounter() - start + updateTicks);
+    }
+
+    void printStats() const {
+        double freq = static_cast<double>(SDL_GetPerformanceFrequency());
+        double avgUs = costFrames ? costTicks * 1e6 / freq / costFrames : 0.0;
+        double maxUs = costMaxTicks * 1e6 / freq;
+        printf("HUD: %.1f us promedio, %.1f us maximo por frame (presupuesto %.0f us)%s\n",
+               avgUs, maxUs, HUD_BUDGET_US, avgUs > HUD_BUDGET_US ? " EXCEDIDO" : "");
+    }
+
+private:
+    void setLine(size_t line, const char* text) {
+        if (line >= lines.size()) {
+            lines.resize(line + 1);
+            lines[line].reserve(64); // que un número más largo no asigne a mitad de partida
+        }
+        if (lines[line] != text) {
+            lines[line] = text;
+            dirty = true;
+        }
+    }
+
+    void rebuild() {
+        vertices.clear();
+        indices.clear();
+        const int margin = 6;
+        size_t longest = 0;
+        for (const auto& line : lines) longest = line.size() > longest ? line.size() : longest;
+
+        // Fondo semitransparente con el texel blanco del atlas
+        SDL_Rect panel = { margin - 3, margin - 3, static_cast<int>(longest) * FONT_CHARACTER_SIZE + 6,
+                           static_cast<int>(lines.size()) * FONT_LINE_HEIGHT + 4 };
+        addQuad(panel, { 0, 0, 0, 0xA0 }, SPRITE_WHITE);
+
+        for (size_t l = 0; l < lines.size(); ++l) {
+            int y = margin + static_cast<int>(l) * FONT_LINE_HEIGHT;
+            for (size_t i = 0; i < lines[l].size(); ++i) {
+                int c = static_cast<unsigned char>(lines[l][i]);
+                if (c <= HUD_FIRST_CHAR || c > HUD_LAST_CHAR) continue;
+                SDL_Rect rect = { margin + static_cast<int>(i) * FONT_CHARACTER_SIZE, y, FONT_CHARACTER_SIZE, FONT_CHARACTER_SIZE };
+                addQuad(rect, { 0xFF, 0xFF, 0xFF, 0xFF }, static_cast<Uint16>(firstGlyph + c - HUD_FIRST_CHAR));
+            }
+        }
+        dirty = false;
+    }
+
+    void addQuad(const SDL_Rect& rect, SDL_Color color, Uint16 sprite) {
+        const TextureAtlas::UV& uv = atlas.uv(sprite);
+        const float x0 = static_cast<float>(rect.x), y0 = static_cast<float>(rect.y);
+        const float x1 = x0 + rect.w, y1 = y0 + rect.h;
+        const int base = static_cast<int>(vertices.size());
+        vertices.push_back({ { x0, y0 }, color, { uv.u0, uv.v0 } });
+        vertices.push_back({ { x1, y0 }, color, { uv.u1, uv.v0 } });
+        vertices.push_back({ { x1, y1 }, color, { uv.u1, uv.v1 } });
+        vertices.push_back({ { x0, y1 }, color, { uv.u0, uv.v1 } });
+        const int quad[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int i : quad) indices.push_back(base + i);
+    }
+
+    // Costo del HUD (update() + draw()), promediado cada segundo para mostrarlo
+    void measure(Uint64 cost) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        costTicks += cost;
+        costFrames++;
+        if (cost > costMaxTicks) costMaxTicks = cost;
+
+        windowTicks += cost;
+        windowFrames++;
+        if (now - windowStart > SDL_GetPerformanceFrequency()) {
+            lastCostUs = windowTicks * 1e6 / SDL_GetPerformanceFrequency() / windowFrames;
+            windowTicks = 0;
+            windowFrames = 0;
+            windowStart = now;
+        }
+    }
+
+    static const Uint16 SPRITE_WHITE = 0;
+
+    TextureAtlas atlas;
+    Uint16 firstGlyph;
+    std::vector<std::string> lines;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    bool dirty;
+
+    Uint64 costTicks, costMaxTicks, costFrames;
+    Uint64 windowTicks, windowFrames, windowStart;
+    double lastCostUs;
+    Uint64 updateTicks;
+};
+
+#endif
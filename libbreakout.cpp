@@ -0,0 +1,111 @@
+#define BREAKOUT_BUILD_LIBRARY
+#include "breakout_api.h"
+#include "breakout.h"
+#include "world_snapshot.h"
+#include <cstdlib>
+
+// Solo la simulación: no se llama a SDL_Init ni se crea ventana o renderer
+struct BreakoutWorld {
+    ECS ecs;
+    int levelScreens;
+    uint32_t seed;
+};
+
+static_assert(sizeof(Position) == 2 * sizeof(float), "BREAKOUT_POSITIONS son dos float");
+static_assert(sizeof(Velocity) == 2 * sizeof(float), "BREAKOUT_VELOCITIES son dos float");
+static_assert(sizeof(Block) == 1, "BREAKOUT_BLOCKS es un uint8_t");
+static_assert(sizeof(Paddle) == 2 * sizeof(int32_t), "BREAKOUT_PADDLES son dos int32_t");
+
+namespace {
+
+int statusCode(GameStatus status) {
+    switch (status) {
+    case GameStatus::GameOver: return BREAKOUT_GAME_OVER;
+    case GameStatus::Won: return BREAKOUT_WON;
+    default: return BREAKOUT_RUNNING;
+    }
+}
+
+template <typename T>
+BreakoutView makeView(const ComponentMap<T>& map) {
+    typedef typename ComponentMap<T>::value_type Pair;
+    const Pair* pairs = map.data();
+    BreakoutView view = { nullptr, nullptr, static_cast<int32_t>(map.size()), static_cast<int32_t>(sizeof(Pair)) };
+    if (pairs) {
+        view.data = &pairs->second;
+        view.ids = reinterpret_cast<const int32_t*>(&pairs->first);
+    }
+    return view;
+}
+
+}
+
+extern "C" {
+
+int breakout_abi_version(void) { return BREAKOUT_ABI_VERSION; }
+
+BreakoutWorld* breakout_create(int levelScreens, uint32_t seed) {
+    BreakoutWorld* world = new BreakoutWorld();
+    world->levelScreens = levelScreens > 0 ? levelScreens : 1;
+    world->seed = seed;
+    breakout_reset(world);
+    return world;
+}
+
+void breakout_destroy(BreakoutWorld* world) { delete world; }
+
+void breakout_reset(BreakoutWorld* world) {
+    srand(world->seed);
+    world->ecs = ECS();
+    initializeEntities(world->ecs, world->levelScreens);
+}
+
+BreakoutWorld* breakout_clone(const BreakoutWorld* world) { return new BreakoutWorld(*world); }
+
+size_t breakout_save(const BreakoutWorld* world, void* buffer, size_t capacity) {
+    size_t bytes = writeWorldSnapshot(world->ecs, nullptr);
+    if (buffer && capacity >= bytes) writeWorldSnapshot(world->ecs, static_cast<Uint8*>(buffer));
+    return bytes;
+}
+
+int breakout_load(BreakoutWorld* world, const void* buffer, size_t size) {
+    return buffer && restoreWorldSnapshot(buffer, size, world->ecs) ? 1 : 0;
+}
+
+int breakout_step(BreakoutWorld* world, uint32_t input, float dt) {
+    applyInput(world->ecs, input);
+    return statusCode(update(world->ecs, dt));
+}
+
+int breakout_run(BreakoutWorld* world, const uint32_t* inputs, int ticks, float dt, int* ticksRun) {
+    int status = BREAKOUT_RUNNING;
+    int t = 0;
+    while (t < ticks && status == BREAKOUT_RUNNING) {
+        applyInput(world->ecs, inputs ? inputs[t] : autopilotInput(world->ecs));
+        status = statusCode(update(world->ecs, dt));
+        ++t;
+    }
+    if (ticksRun) *ticksRun = t;
+    return status;
+}
+
+int breakout_score(const BreakoutWorld* world) { return world->ecs.score; }
+int breakout_blocks_left(const BreakoutWorld* world) { return world->ecs.blocksLeft; }
+int breakout_world_height(const BreakoutWorld* world) { return world->ecs.worldHeight; }
+
+BreakoutView breakout_view(const BreakoutWorld* world, int component) {
+    const ECS& ecs = world->ecs;
+    switch (component) {
+    case BREAKOUT_POSITIONS: return makeView(ecs.positions);
+    case BREAKOUT_VELOCITIES: return makeView(ecs.velocities);
+    case BREAKOUT_BLOCKS: return makeView(ecs.blocks);
+    case BREAKOUT_PADDLES: return makeView(ecs.paddles);
+    case BREAKOUT_BALLS: return makeView(ecs.balls);
+    default: {
+        BreakoutView empty = { nullptr, nullptr, 0, 0 };
+        return empty;
+    }
+    }
+}
+
+}
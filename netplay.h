@@ -0,0 +1,501 @@
+#ifndef BREAKOUT_NETPLAY_H
+#define BREAKOUT_NETPLAY_H
+
+#include "inc/SDL.h"
+#include "breakout.h"
+#include "state_hash.h"
+#include "telemetry.h"
+#include "world_snapshot.h"
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX // winsock2.h trae windows.h: sin las macros min y max, que rompen rollbackUs.max()
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Versus en red con rollback (al estilo de GGPO): cada proceso simula el
+// partido entero. La entrada local se usa enseguida (con unos frames de
+// demora) y se manda al otro; la del otro, mientras no llega, se predice
+// repitiendo la última confirmada. Cuando llega una entrada distinta de la
+// predicha, el mundo vuelve a la foto de ese frame y se resimula hasta el
+// presente con la entrada correcta. La simulación es determinista: mismo
+// binario, misma semilla y dT fijo. Para comprobarlo, cada uno manda el hash
+// del mundo en el último frame que ya no puede cambiar y el otro lo compara
+// con el suyo: si difieren, las simulaciones se separaron (desync).
+const int NETPLAY_HZ = 60;
+const int ROLLBACK_FRAMES = 16;      // cuánto se puede adelantar un jugador al otro antes de esperar
+const int INPUT_RING = 128;          // entradas guardadas por jugador
+const int MAX_PACKET_INPUTS = 64;    // entradas sin confirmar que entran en un paquete
+const int MAX_PACKET_BYTES = 32 + MAX_PACKET_INPUTS;
+const int MAX_QUEUED_PACKETS = 256;  // paquetes demorados por el simulador de red, por defecto
+const Uint32 NETPLAY_MAGIC = 0x324E4B42; // "BKN2": con hash del mundo
+const int PACKET_HEADER_BYTES = 29;
+
+// Condiciones simuladas de la red: demora de ida, variación y pérdida
+struct NetConditions {
+    int latencyMs = 0;
+    int jitterMs = 0;
+    double loss = 0.0; // 0 a 1
+};
+
+#if defined(_WIN32)
+typedef SOCKET SocketHandle;
+const SocketHandle NO_SOCKET = INVALID_SOCKET;
+#else
+typedef int SocketHandle;
+const SocketHandle NO_SOCKET = -1;
+#endif
+
+// Cuántos paquetes tiene que poder demorar a la vez el simulador si se mandan
+// packetsPerTick por tick a NETPLAY_HZ, con el doble de margen por si el
+// bucle se atrasa
+inline int delayQueueCapacity(const NetConditions& conditions, int packetsPerTick) {
+    int ticks = (conditions.latencyMs + conditions.jitterMs) * NETPLAY_HZ / 1000 + 1;
+    int capacity = 2 * packetsPerTick * ticks;
+    return capacity > MAX_QUEUED_PACKETS ? capacity : MAX_QUEUED_PACKETS;
+}
+
+// Socket UDP no bloqueante en un puerto de 127.0.0.1, que manda a otro
+// puerto (remotePort por defecto). Lo que se manda pasa por el simulador de
+// red: se descarta con probabilidad loss o se demora latency +- jitter ms (y
+// puede llegar desordenado). Se demoran a lo sumo maxQueued paquetes a la
+// vez; los que no entran se descartan y se cuentan en overflowed, nunca se
+// mandan sin demora. Los buffers de cada lugar de la cola se crean al usarlo
+// y crecen hasta el paquete más grande que pasó por ahí.
+class NetLink {
+public:
+    explicit NetLink(const NetConditions& conditions, int maxQueued = MAX_QUEUED_PACKETS)
+        : conditions(conditions), sock(NO_SOCKET), remotePort(0), maxQueued(maxQueued), queued(0), rng(0x9E3779B9u) {
+        queue.reserve(maxQueued);
+    }
+
+    ~NetLink() { close(); }
+
+    NetLink(const NetLink&) = delete;
+    NetLink& operator=(const NetLink&) = delete;
+
+    bool open(int localPort, int remotePort) {
+#if defined(_WIN32)
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+        sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock == NO_SOCKET) return false;
+        sockaddr_in local = loopback(localPort);
+        if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            close();
+            return false;
+        }
+#if defined(_WIN32)
+        u_long nonBlocking = 1;
+        ioctlsocket(sock, FIONBIO, &nonBlocking);
+#else
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+        this->remotePort = remotePort;
+        rng ^= static_cast<Uint32>(localPort) * 2654435761u;
+        return true;
+    }
+
+    void close() {
+        if (sock == NO_SOCKET) return;
+#if defined(_WIN32)
+        closesocket(sock);
+        WSACleanup();
+#else
+        ::close(sock);
+#endif
+        sock = NO_SOCKET;
+    }
+
+    void send(const Uint8* data, int size) { sendTo(remotePort, data, size); }
+
+    void sendTo(int port, const Uint8* data, int size) {
+        ++sent;
+        bytesSent += size;
+        if (conditions.loss > 0.0 && random01() < conditions.loss) {
+            ++dropped;
+            return;
+        }
+        int delayMs = conditions.latencyMs;
+        if (conditions.jitterMs > 0) delayMs += static_cast<int>(random01() * (2 * conditions.jitterMs + 1)) - conditions.jitterMs;
+        if (delayMs <= 0) {
+            sendNow(port, data, size);
+            return;
+        }
+        if (queued == maxQueued) {
+            ++overflowed;
+            return;
+        }
+        if (queued == static_cast<int>(queue.size())) queue.emplace_back();
+        Delayed& d = queue[queued++];
+        d.due = SDL_GetPerformanceCounter() + static_cast<Uint64>(delayMs) * SDL_GetPerformanceFrequency() / 1000;
+        d.port = port;
+        d.size = size;
+        if (static_cast<int>(d.data.size()) < size) d.data.resize(size);
+        memcpy(d.data.data(), data, size);
+    }
+
+    // Mando lo que ya cumplió su demora
+    void flush() {
+        Uint64 now = SDL_GetPerformanceCounter();
+        int i = 0;
+        while (i < queued) {
+            if (queue[i].due <= now) {
+                sendNow(queue[i].port, queue[i].data.data(), queue[i].size);
+                std::swap(queue[i], queue[--queued]); // swap: los buffers no se copian ni se liberan
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // Bytes del próximo paquete recibido, o -1 si no hay; en fromPort, quién lo mandó
+    int receive(Uint8* data, int capacity, int* fromPort = nullptr) {
+        if (sock == NO_SOCKET) return -1;
+        sockaddr_in from;
+        socklen_t fromSize = sizeof(from);
+        int n = static_cast<int>(recvfrom(sock, reinterpret_cast<char*>(data), capacity, 0, reinterpret_cast<sockaddr*>(&from), &fromSize));
+        if (n < 0) return -1;
+        if (fromPort) *fromPort = ntohs(from.sin_port);
+        ++received;
+        return n;
+    }
+
+    Uint64 sent = 0, dropped = 0, received = 0, bytesSent = 0;
+    Uint64 overflowed = 0; // descartados porque la cola de demora estaba llena
+
+private:
+    struct Delayed {
+        Uint64 due;
+        int port;
+        int size;
+        std::vector<Uint8> data;
+    };
+
+    static sockaddr_in loopback(int port) {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<unsigned short>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return addr;
+    }
+
+    void sendNow(int port, const Uint8* data, int size) {
+        sockaddr_in remote = loopback(port);
+        sendto(sock, reinterpret_cast<const char*>(data), size, 0, reinterpret_cast<const sockaddr*>(&remote), sizeof(remote));
+    }
+
+    // xorshift32 a [0, 1); no toco rand(), que decide los colores del nivel
+    double random01() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng / 4294967296.0;
+    }
+
+    NetConditions conditions;
+    SocketHandle sock;
+    int remotePort;
+    std::vector<Delayed> queue;
+    int maxQueued;
+    int queued;
+    Uint32 rng;
+};
+
+// Paquete de entradas:
+//   magic, ack (el próximo frame que espero del otro: los anteriores ya
+//   los tengo), frame actual del que manda, su ventaja en frames sobre el
+//   otro, el último frame confirmado y el hash del mundo después de ese
+//   frame, el primer frame de las entradas y la cantidad, y una entrada por byte.
+// Cada paquete repite todas las entradas que el otro todavía no confirmó, así
+// un paquete perdido se cubre con el siguiente.
+inline void putLE32(Uint8* p, Sint32 v) {
+    Uint32 u = SDL_SwapLE32(static_cast<Uint32>(v));
+    memcpy(p, &u, sizeof(u));
+}
+
+inline Sint32 getLE32(const Uint8* p) {
+    Uint32 u;
+    memcpy(&u, p, sizeof(u));
+    return static_cast<Sint32>(SDL_SwapLE32(u));
+}
+
+class RollbackSession {
+public:
+    RollbackSession(ECS& ecs, NetLink& link, int localPlayer, int inputDelay)
+        : ecs(ecs), link(link), localPlayer(localPlayer), remotePlayer(1 - localPlayer),
+          inputDelay(inputDelay < 0 ? 0 : (inputDelay > ROLLBACK_FRAMES / 2 ? ROLLBACK_FRAMES / 2 : inputDelay)),
+          snapshots(ROLLBACK_FRAMES + 1) {
+        memset(localInputs, 0, sizeof(localInputs));
+        memset(remoteInputs, 0, sizeof(remoteInputs));
+        memset(usedRemote, 0, sizeof(usedRemote));
+        memset(frameHashes, 0, sizeof(frameHashes));
+        localNext = this->inputDelay; // los primeros frames van sin botones
+    }
+
+    // Espero el primer paquete del otro, mandando paquetes vacíos mientras tanto
+    bool connect(double seconds) {
+        const Uint64 freq = SDL_GetPerformanceFrequency();
+        const Uint64 end = SDL_GetPerformanceCounter() + static_cast<Uint64>(seconds * freq);
+        while (SDL_GetPerformanceCounter() < end) {
+            send();
+            if (receive()) return true;
+            SDL_Delay(5);
+        }
+        return false;
+    }
+
+    // Un tick de juego con los botones locales (sin correr). Devuelve false si
+    // no avanzó: el otro viene muy atrasado, o el partido ya terminó.
+    bool advance(Uint32 buttons) {
+        receive();
+        if (endFrame >= 0) {
+            send();
+            return false;
+        }
+        if (localNext == frame + inputDelay) {
+            localInputs[localNext % INPUT_RING] = static_cast<Uint8>(buttons & (INPUT_LEFT | INPUT_RIGHT));
+            ++localNext;
+        }
+        send();
+
+        // Sin la entrada del otro de hace ROLLBACK_FRAMES frames no puedo
+        // seguir prediciendo: ya no tendría la foto para volver
+        if (frame - remoteNext >= ROLLBACK_FRAMES || localNext - remoteAck >= INPUT_RING - 1) {
+            ++stalls;
+            return false;
+        }
+        // Si voy más de un frame adelantado respecto del otro (la diferencia de
+        // ventajas es el doble del adelanto), cedo un frame para que me alcance
+        if (frame - skippedAt > NETPLAY_HZ / 4 && localAdvantage() - remoteAdvantage > 2) {
+            skippedAt = frame;
+            ++skips;
+            return false;
+        }
+        simulate(frame);
+        ++frame;
+        hashSettled();
+        return true;
+    }
+
+    // Sin avanzar: solo mando y recibo
+    void pump() {
+        receive();
+        send();
+    }
+
+    int getFrame() const { return frame; }
+    GameStatus getStatus() const { return status; }
+    bool confirmed() const { return remoteNext >= frame; }       // todo lo simulado usó entradas confirmadas
+    bool finished() const { return endFrame >= 0 && confirmed(); } // el fin del partido ya no puede cambiar
+    int getDesyncFrame() const { return desyncFrame; } // -1 si los hashes coinciden
+    bool peerSilent(double seconds) const {
+        return lastReceive && SDL_GetPerformanceCounter() - lastReceive > static_cast<Uint64>(seconds * SDL_GetPerformanceFrequency());
+    }
+
+    void printStats() const {
+        printf("Netplay: jugador %d, %d frames, demora de entrada %d, %llu esperas por el otro, %llu frames cedidos\n", localPlayer, frame,
+               inputDelay, static_cast<unsigned long long>(stalls), static_cast<unsigned long long>(skips));
+        printf("Red: %llu paquetes enviados (%llu perdidos por el simulador, %llu con la cola de demora llena), %llu recibidos, %.1f bytes por paquete\n",
+               static_cast<unsigned long long>(link.sent), static_cast<unsigned long long>(link.dropped),
+               static_cast<unsigned long long>(link.overflowed),
+               static_cast<unsigned long long>(link.received), link.sent ? static_cast<double>(link.bytesSent) / link.sent : 0.0);
+        printf("Rollbacks: %llu (%.1f%% de los frames), %llu frames resimulados, el mas largo de %d frames en %u us\n",
+               static_cast<unsigned long long>(rollbackUs.count()), frame ? 100.0 * rollbackUs.count() / frame : 0.0,
+               static_cast<unsigned long long>(resimulated), deepestRollback, deepestRollbackUs);
+        printf("rollback p50 %u  p99 %u  max %u us (presupuesto del frame %d us)\n", rollbackUs.percentile(50), rollbackUs.percentile(99),
+               rollbackUs.max(), 1000000 / NETPLAY_HZ);
+        if (desyncFrame >= 0) {
+            printf("DESYNC: el mundo difiere del otro en el frame %d (el ultimo igual comparado fue el %d)\n", desyncFrame, lastGoodHash);
+        } else {
+            printf("Hashes: %llu frames comparados con el otro, todos iguales (el ultimo, el %d)\n",
+                   static_cast<unsigned long long>(hashChecks), lastGoodHash);
+        }
+    }
+
+private:
+    int localAdvantage() const { return frame - remoteFrame; }
+
+    // Los frames anteriores a este se simularon con entradas confirmadas
+    int settled() const { return remoteNext < frame ? remoteNext : frame; }
+
+    Uint32 predictRemote(int f) const {
+        if (f < remoteNext) return remoteInputs[f % INPUT_RING];
+        return remoteNext > 0 ? remoteInputs[(remoteNext - 1) % INPUT_RING] : 0;
+    }
+
+    // Guardo la foto del frame y lo simulo con la entrada local y la remota (o su predicción)
+    void simulate(int f) {
+        snapshots[f % snapshots.size()].save(ecs);
+        Uint32 remote = predictRemote(f);
+        usedRemote[f % INPUT_RING] = static_cast<Uint8>(remote);
+        applyInput(ecs, playerInput(localInputs[f % INPUT_RING], localPlayer) | playerInput(remote, remotePlayer));
+        status = update(ecs, 1.0f / NETPLAY_HZ);
+        if (status != GameStatus::Running && endFrame < 0) endFrame = f;
+    }
+
+    // Hash de cada frame una sola vez, cuando ya no puede cambiar (y no en
+    // cada resimulación). El mundo después de f es la foto de f + 1, que
+    // todavía está porque nunca se va más de ROLLBACK_FRAMES por delante de
+    // lo confirmado, o el mundo actual si f es el último simulado.
+    void hashSettled() {
+        for (const int upTo = settled(); hashedFrames < upTo; ++hashedFrames) {
+            const int f = hashedFrames;
+            if (f + 1 == frame) {
+                frameHashes[f % INPUT_RING] = hasher.hash(ecs);
+            } else {
+                snapshots[(f + 1) % snapshots.size()].restore(settledWorld);
+                frameHashes[f % INPUT_RING] = hasher.hash(settledWorld);
+            }
+        }
+    }
+
+    // Comparo el último hash que mandó el otro, si ese frame ya es definitivo acá
+    void checkHash() {
+        const int f = remoteHashFrame;
+        if (f <= checkedHashFrame || f >= hashedFrames || hashedFrames - f >= INPUT_RING) return;
+        checkedHashFrame = f;
+        ++hashChecks;
+        if (frameHashes[f % INPUT_RING] == remoteHash) {
+            if (desyncFrame < 0) lastGoodHash = f;
+        } else if (desyncFrame < 0) {
+            desyncFrame = f;
+            printf("DESYNC en el frame %d: hash local %08x, del otro %08x (el frame %d coincidia)\n", f, frameHashes[f % INPUT_RING],
+                   remoteHash, lastGoodHash);
+        }
+    }
+
+    void send() {
+        Uint8 packet[MAX_PACKET_BYTES];
+        int first = remoteAck;
+        int count = localNext - first;
+        if (count > MAX_PACKET_INPUTS) count = MAX_PACKET_INPUTS;
+        if (count < 0) count = 0;
+        int advantage = localAdvantage();
+        int hashFrame = hashedFrames - 1;
+        putLE32(packet, static_cast<Sint32>(NETPLAY_MAGIC));
+        putLE32(packet + 4, remoteNext);
+        putLE32(packet + 8, frame);
+        putLE32(packet + 12, advantage);
+        putLE32(packet + 16, hashFrame);
+        putLE32(packet + 20, static_cast<Sint32>(hashFrame >= 0 ? frameHashes[hashFrame % INPUT_RING] : 0));
+        putLE32(packet + 24, first);
+        packet[28] = static_cast<Uint8>(count);
+        for (int i = 0; i < count; ++i) packet[PACKET_HEADER_BYTES + i] = localInputs[(first + i) % INPUT_RING];
+        link.send(packet, PACKET_HEADER_BYTES + count);
+        link.flush();
+    }
+
+    // Leo todo lo que llegó; true si llegó algo. Si alguna entrada confirmada
+    // no es la que predije, vuelvo atrás y resimulo.
+    bool receive() {
+        link.flush();
+        Uint8 packet[MAX_PACKET_BYTES];
+        int rollbackFrom = INT_MAX;
+        bool any = false;
+        int n;
+        // Un paquete corto o ajeno se salta; cortar ahí dejaría lo que viene
+        // detrás para el frame siguiente
+        while ((n = link.receive(packet, sizeof(packet))) >= 0) {
+            if (n < PACKET_HEADER_BYTES || static_cast<Uint32>(getLE32(packet)) != NETPLAY_MAGIC) continue;
+            int count = packet[28];
+            if (PACKET_HEADER_BYTES + count > n) continue;
+            any = true;
+            lastReceive = SDL_GetPerformanceCounter();
+            int ack = getLE32(packet + 4);
+            if (ack > remoteAck && ack <= localNext) remoteAck = ack;
+            int sentFrame = getLE32(packet + 8);
+            if (sentFrame > remoteFrame) {
+                remoteFrame = sentFrame;
+                remoteAdvantage = getLE32(packet + 12);
+            }
+            int hashFrame = getLE32(packet + 16);
+            if (hashFrame > remoteHashFrame) {
+                remoteHashFrame = hashFrame;
+                remoteHash = static_cast<Uint32>(getLE32(packet + 20));
+            }
+            int first = getLE32(packet + 24);
+            for (int i = 0; i < count; ++i) {
+                int f = first + i;
+                if (f < remoteNext) continue; // repetida
+                if (f > remoteNext) break;    // falta una anterior: llegará repetida en otro paquete
+                Uint8 input = packet[PACKET_HEADER_BYTES + i];
+                remoteInputs[f % INPUT_RING] = input;
+                if (f < frame && usedRemote[f % INPUT_RING] != input && f < rollbackFrom) rollbackFrom = f;
+                ++remoteNext;
+            }
+        }
+        if (rollbackFrom < frame) rollback(rollbackFrom);
+        hashSettled();
+        checkHash();
+        return any;
+    }
+
+    void rollback(int from) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        snapshots[from % snapshots.size()].restore(ecs);
+        if (endFrame >= from) endFrame = -1;
+        const int to = frame;
+        for (int f = from; f < to; ++f) {
+            simulate(f);
+            ++resimulated;
+            if (status != GameStatus::Running) {
+                frame = f + 1; // con la entrada correcta el partido terminó antes
+                break;
+            }
+        }
+        Uint32 us = elapsedUs(start, SDL_GetPerformanceCounter());
+        rollbackUs.record(us);
+        if (to - from > deepestRollback) {
+            deepestRollback = to - from;
+            deepestRollbackUs = us;
+        }
+    }
+
+    ECS& ecs;
+    NetLink& link;
+    int localPlayer, remotePlayer;
+    int inputDelay;
+    std::vector<WorldSnapshot> snapshots; // foto al empezar cada uno de los últimos frames
+    Uint8 localInputs[INPUT_RING];
+    Uint8 remoteInputs[INPUT_RING];
+    Uint8 usedRemote[INPUT_RING];         // entrada remota con la que se simuló cada frame
+    Uint32 frameHashes[INPUT_RING];       // hash del mundo después de cada frame confirmado
+    int hashedFrames = 0;                 // los frames anteriores ya tienen hash
+    ECS settledWorld;                     // para hashear desde una foto
+    WorldHasher hasher;
+    int frame = 0;                        // próximo frame a simular
+    int localNext = 0;                    // próximo frame de la entrada local
+    int remoteNext = 0;                   // próximo frame de la entrada remota (los anteriores están confirmados)
+    int remoteAck = 0;                    // el otro ya tiene mis entradas anteriores a este frame
+    int remoteFrame = 0, remoteAdvantage = 0;
+    int endFrame = -1;                    // frame en que terminó el partido, -1 si sigue
+    int remoteHashFrame = -1;             // último frame confirmado del que mandó hash el otro
+    Uint32 remoteHash = 0;
+    int checkedHashFrame = -1, lastGoodHash = -1;
+    int desyncFrame = -1;                 // primer frame comparado con hash distinto
+    Uint64 hashChecks = 0;
+    int skippedAt = 0;
+    GameStatus status = GameStatus::Running;
+    Uint64 lastReceive = 0;
+    Uint64 stalls = 0, skips = 0, resimulated = 0;
+    int deepestRollback = 0;
+    Uint32 deepestRollbackUs = 0;
+    HdrHistogram rollbackUs;
+};
+
+#endif
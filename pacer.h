@@ -0,0 +1,160 @@
+#ifndef BREAKOUT_PACER_H
+#define BREAKOUT_PACER_H
+
+#include "inc/SDL.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Cómo se limita la duración de cada frame
+enum PaceMode {
+    PACE_FIXED,    // duerme y termina con espera activa hasta el próximo frame
+    PACE_VSYNC,    // SDL_RenderPresent espera al refresco del monitor
+    PACE_UNCAPPED, // sin límite
+    PACE_LEGACY    // el limitador anterior con SDL_GetTicks/SDL_Delay, para comparar
+};
+
+inline bool parsePaceMode(const char* name, PaceMode& mode) {
+    if (strcmp(name, "fixed") == 0) mode = PACE_FIXED;
+    else if (strcmp(name, "vsync") == 0) mode = PACE_VSYNC;
+    else if (strcmp(name, "uncapped") == 0) mode = PACE_UNCAPPED;
+    else if (strcmp(name, "legacy") == 0) mode = PACE_LEGACY;
+    else return false;
+    return true;
+}
+
+inline const char* paceModeName(PaceMode mode) {
+    switch (mode) {
+    case PACE_FIXED: return "fixed";
+    case PACE_VSYNC: return "vsync";
+    case PACE_UNCAPPED: return "uncapped";
+    default: return "legacy";
+    }
+}
+
+// Cuánto se pasa SDL_Delay(1) del milisegundo pedido, en el peor caso de
+// unas cuantas muestras. Es el margen que se deja para la espera activa.
+inline Uint64 calibrateSleepOvershoot(int samples = 20) {
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    Uint64 worst = 0;
+    for (int i = 0; i < samples; ++i) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        SDL_Delay(1);
+        Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+        Uint64 over = elapsed > freq / 1000 ? elapsed - freq / 1000 : 0;
+        if (over > worst) worst = over;
+    }
+    return worst;
+}
+
+// Espero hasta deadline (en cuentas de SDL_GetPerformanceCounter): duermo de a
+// milisegundos mientras sobre más que margin, después cedo el procesador con
+// SDL_Delay(0) y el último tramo lo hago en espera activa.
+inline void sleepUntil(Uint64 deadline, Uint64 margin) {
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const Uint64 spinTicks = freq / 5000; // 200 us
+    for (;;) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now >= deadline) return;
+        Uint64 remaining = deadline - now;
+        if (remaining > margin + freq / 1000) {
+            SDL_Delay(static_cast<Uint32>((remaining - margin) * 1000 / freq));
+        } else if (remaining > spinTicks) {
+            SDL_Delay(0);
+        }
+    }
+}
+
+// Duración de frame medida con el contador de alta resolución: media,
+// varianza (Welford), mínimo y máximo
+struct FrameTimeStats {
+    Uint64 count = 0;
+    double mean = 0.0, m2 = 0.0;
+    double minMs = 0.0, maxMs = 0.0;
+
+    void add(double ms) {
+        if (count == 0 || ms < minMs) minMs = ms;
+        if (count == 0 || ms > maxMs) maxMs = ms;
+        ++count;
+        double delta = ms - mean;
+        mean += delta / count;
+        m2 += delta * (ms - mean);
+    }
+
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+};
+
+// Marca el ritmo del bucle principal. beginFrame() devuelve el dT del frame
+// medido con SDL_GetPerformanceCounter y endFrame() espera lo que falte según
+// el modo. Los frames se agendan contra una fecha límite que avanza un período
+// por frame, así el error de un frame no se acumula en los siguientes.
+class FramePacer {
+public:
+    FramePacer(PaceMode mode, int fps)
+        : mode(mode), fps(fps > 0 ? fps : 60), freq(SDL_GetPerformanceFrequency()),
+          period(freq / (fps > 0 ? fps : 60)), margin(0), deadline(0), frameStart(0), lastTicks(0), legacyStart(0) {
+        if (mode == PACE_FIXED) margin = calibrateSleepOvershoot();
+    }
+
+    // VSync solo en modo vsync; en los demás modos lo apago para que no limite
+    void attach(SDL_Renderer* renderer) {
+        if (SDL_RenderSetVSync(renderer, mode == PACE_VSYNC ? 1 : 0) != 0 && mode == PACE_VSYNC) {
+            printf("El renderer no soporta VSync, sigo sin limite\n");
+        }
+    }
+
+    // Segundos desde el frame anterior (0 en el primero)
+    float beginFrame() {
+        Uint64 now = SDL_GetPerformanceCounter();
+        float dT = 0.0f;
+        if (mode == PACE_LEGACY) {
+            // Como antes: milisegundos enteros de SDL_GetTicks
+            Uint32 ticks = SDL_GetTicks();
+            if (frameStart != 0) dT = (ticks - lastTicks) / 1000.0f;
+            lastTicks = ticks;
+            legacyStart = ticks;
+        } else if (frameStart != 0) {
+            dT = static_cast<float>(static_cast<double>(now - frameStart) / freq);
+        }
+        if (frameStart != 0) stats.add((now - frameStart) * 1000.0 / freq);
+        if (deadline == 0) deadline = now;
+        frameStart = now;
+        return dT;
+    }
+
+    void endFrame() {
+        if (mode == PACE_FIXED) {
+            deadline += period;
+            Uint64 now = SDL_GetPerformanceCounter();
+            if (now > deadline + period) deadline = now; // muy atrasado: no intento recuperar
+            sleepUntil(deadline, margin);
+        } else if (mode == PACE_LEGACY) {
+            const float frameDuration = (1.0f / fps) * 1000.0f;
+            Uint32 actualFrameDuration = SDL_GetTicks() - legacyStart;
+            if (actualFrameDuration < frameDuration) {
+                SDL_Delay(static_cast<Uint32>(frameDuration - actualFrameDuration));
+            }
+        }
+    }
+
+    PaceMode getMode() const { return mode; }
+    const FrameTimeStats& getStats() const { return stats; }
+
+    void printStats() const {
+        printf("Ritmo (%s, %d FPS): %llu frames, media %.3f ms, desvio %.3f ms, varianza %.4f ms2, min %.3f ms, max %.3f ms",
+               paceModeName(mode), fps, static_cast<unsigned long long>(stats.count), stats.mean,
+               std::sqrt(stats.variance()), stats.variance(), stats.minMs, stats.maxMs);
+        if (mode == PACE_FIXED) printf(", margen de sueno %.3f ms", margin * 1000.0 / freq);
+        printf("\n");
+    }
+
+private:
+    PaceMode mode;
+    int fps;
+    Uint64 freq, period, margin;
+    Uint64 deadline, frameStart;
+    Uint32 lastTicks, legacyStart;
+    FrameTimeStats stats;
+};
+
+#endif
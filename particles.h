@@ -0,0 +1,209 @@
+#ifndef BREAKOUT_PARTICLES_H
+#define BREAKOUT_PARTICLES_H
+
+#include "inc/SDL.h"
+#include <cstdio>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const float PARTICLE_GRAVITY = 400.0f;
+const float PARTICLE_SIZE = 2.0f;
+
+// Partículas en un pool de capacidad fija con arreglos separados por campo
+// (SoA). La integración va de a 4 con SSE2 cuando está disponible, las muertas
+// se compactan sin saltos condicionales y todas se dibujan con un solo
+// SDL_RenderGeometryRaw. Usa su propio generador para no tocar rand().
+class ParticleSystem {
+public:
+    explicit ParticleSystem(int capacity)
+        : capacity(capacity), count(0), rng(0x9E3779B9u),
+          x(capacity), y(capacity), vx(capacity), vy(capacity), life(capacity), color(capacity) {
+        // La geometría se reserva entera de entrada para no asignar a mitad de partida
+        xy.reserve(static_cast<size_t>(capacity) * 8);
+        colors.reserve(static_cast<size_t>(capacity) * 4);
+        growIndices(capacity);
+    }
+
+    int size() const { return count; }
+    int getCapacity() const { return capacity; }
+
+    // Explosión de partículas desde un punto; si el pool está lleno se emiten menos
+    void emit(float px, float py, int amount, SDL_Color c, float speed = 180.0f, float maxLife = 1.0f) {
+        if (amount > capacity - count) amount = capacity - count;
+        const Uint32 packed = pack(c);
+        for (int k = 0; k < amount; ++k) {
+            int i = count++;
+            float dx = nextRandom() * 2.0f - 1.0f, dy = nextRandom() * 2.0f - 1.0f;
+            float s = speed * (0.3f + 0.7f * nextRandom());
+            x[i] = px;
+            y[i] = py;
+            vx[i] = dx * s;
+            vy[i] = dy * s;
+            life[i] = maxLife * (0.5f + 0.5f * nextRandom());
+            color[i] = packed;
+        }
+    }
+
+    void update(float dT) {
+        integrate(dT);
+        compact();
+    }
+
+    // Quads de PARTICLE_SIZE x PARTICLE_SIZE; el alfa baja en el último medio segundo de vida
+    void buildGeometry() {
+        const size_t vertices = static_cast<size_t>(count) * 4;
+        xy.resize(vertices * 2);
+        colors.resize(vertices);
+        growIndices(count);
+
+        float* out = xy.data();
+        SDL_Color* col = colors.data();
+        for (int i = 0; i < count; ++i) {
+            const float x0 = x[i], y0 = y[i], x1 = x0 + PARTICLE_SIZE, y1 = y0 + PARTICLE_SIZE;
+            out[0] = x0; out[1] = y0;
+            out[2] = x1; out[3] = y0;
+            out[4] = x1; out[5] = y1;
+            out[6] = x0; out[7] = y1;
+            out += 8;
+
+            SDL_Color c = unpack(color[i]);
+            float fade = life[i] * 2.0f;
+            c.a = static_cast<Uint8>(c.a * (fade < 1.0f ? fade : 1.0f));
+            col[0] = col[1] = col[2] = col[3] = c;
+            col += 4;
+        }
+    }
+
+    // Una sola llamada de dibujo para todas las partículas
+    int draw(SDL_Renderer* renderer) {
+        if (count == 0) return 0;
+        buildGeometry();
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_RenderGeometryRaw(renderer, NULL, xy.data(), 2 * sizeof(float), colors.data(), sizeof(SDL_Color),
+                              NULL, 0, count * 4, indices.data(), count * 6, sizeof(int));
+        return 1;
+    }
+
+private:
+    void integrate(float dT) {
+        int i = 0;
+#if defined(__SSE2__)
+        const __m128 vdt = _mm_set1_ps(dT);
+        const __m128 vg = _mm_set1_ps(PARTICLE_GRAVITY * dT);
+        for (; i + 4 <= count; i += 4) {
+            __m128 px = _mm_loadu_ps(&x[i]);
+            __m128 py = _mm_loadu_ps(&y[i]);
+            __m128 pvx = _mm_loadu_ps(&vx[i]);
+            __m128 pvy = _mm_loadu_ps(&vy[i]);
+            __m128 pl = _mm_loadu_ps(&life[i]);
+            _mm_storeu_ps(&x[i], _mm_add_ps(px, _mm_mul_ps(pvx, vdt)));
+            _mm_storeu_ps(&y[i], _mm_add_ps(py, _mm_mul_ps(pvy, vdt)));
+            _mm_storeu_ps(&vy[i], _mm_add_ps(pvy, vg));
+            _mm_storeu_ps(&life[i], _mm_sub_ps(pl, vdt));
+        }
+#endif
+        for (; i < count; ++i) {
+            x[i] += vx[i] * dT;
+            y[i] += vy[i] * dT;
+            vy[i] += PARTICLE_GRAVITY * dT;
+            life[i] -= dT;
+        }
+    }
+
+    // Muevo las vivas al principio. Desde la primera muerta copio siempre y
+    // avanzo el destino solo si la partícula vive, sin ramas que predecir.
+    void compact() {
+        int first = 0;
+        while (first < count && life[first] > 0.0f) ++first;
+        int w = first;
+        for (int i = first; i < count; ++i) {
+            x[w] = x[i];
+            y[w] = y[i];
+            vx[w] = vx[i];
+            vy[w] = vy[i];
+            life[w] = life[i];
+            color[w] = color[i];
+            w += life[i] > 0.0f;
+        }
+        count = w;
+    }
+
+    void growIndices(int particles) {
+        size_t have = indices.size() / 6;
+        if (have >= static_cast<size_t>(particles)) return;
+        indices.resize(static_cast<size_t>(particles) * 6);
+        for (size_t p = have; p < static_cast<size_t>(particles); ++p) {
+            int base = static_cast<int>(p * 4);
+            int* idx = &indices[p * 6];
+            idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+            idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+        }
+    }
+
+    // xorshift32 a [0, 1)
+    float nextRandom() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return (rng >> 8) * (1.0f / 16777216.0f);
+    }
+
+    static Uint32 pack(SDL_Color c) {
+        return static_cast<Uint32>(c.r) | (static_cast<Uint32>(c.g) << 8) | (static_cast<Uint32>(c.b) << 16) | (static_cast<Uint32>(c.a) << 24);
+    }
+
+    static SDL_Color unpack(Uint32 v) {
+        return { static_cast<Uint8>(v), static_cast<Uint8>(v >> 8), static_cast<Uint8>(v >> 16), static_cast<Uint8>(v >> 24) };
+    }
+
+    int capacity;
+    int count;
+    Uint32 rng;
+    std::vector<float> x, y, vx, vy, life;
+    std::vector<Uint32> color;
+
+    // Geometría reutilizada entre frames
+    std::vector<float> xy;
+    std::vector<SDL_Color> colors;
+    std::vector<int> indices;
+};
+
+// Benchmark: mantengo el pool lleno emitiendo lo que muere y mido integración
+// más compactación y armado de geometría por frame
+inline int benchParticles(int live, int frames) {
+    ParticleSystem particles(live);
+    const SDL_Color color = { 0xFF, 0xA0, 0x40, 0xFF };
+    const float dT = 1.0f / 60.0f;
+    Uint64 simTicks = 0, geometryTicks = 0;
+
+    for (int frame = -30; frame < frames; ++frame) {
+        particles.emit(375.0f, 240.0f, live - particles.size(), color, 180.0f, 3.0f);
+
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        particles.update(dT);
+        Uint64 t1 = SDL_GetPerformanceCounter();
+        particles.buildGeometry();
+        Uint64 t2 = SDL_GetPerformanceCounter();
+
+        if (frame >= 0) { // los primeros 30 frames son de calentamiento
+            simTicks += t1 - t0;
+            geometryTicks += t2 - t1;
+        }
+    }
+
+    const double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+    double simMs = simTicks * msPerTick / frames;
+    double geometryMs = geometryTicks * msPerTick / frames;
+#if defined(__SSE2__)
+    const char* path = "SSE2";
+#else
+    const char* path = "escalar";
+#endif
+    printf("Particulas: %d vivas, %d frames, integracion+compactacion %.3f ms (%s), geometria %.3f ms, total %.3f ms de 16.67 ms\n",
+           live, frames, simMs, path, geometryMs, simMs + geometryMs);
+    return 0;
+}
+
+#endif
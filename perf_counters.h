@@ -0,0 +1,259 @@
+#ifndef BREAKOUT_PERF_COUNTERS_H
+#define BREAKOUT_PERF_COUNTERS_H
+
+#include "inc/SDL.h"
+#include "profiler.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BREAKOUT_PERF_EVENTS 1
+#else
+#define BREAKOUT_PERF_EVENTS 0
+#endif
+
+// Contadores de hardware que se leen juntos en cada zona
+enum PerfCounter { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_BRANCH_MISSES, PERF_COUNTER_COUNT };
+
+const char* const PERF_COUNTER_NAMES[PERF_COUNTER_COUNT] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+
+struct PerfSample {
+    Uint64 values[PERF_COUNTER_COUNT];
+};
+
+// Grupo de perf_event_open para el hilo que lo abre: el kernel programa todos
+// los contadores a la vez, así una lectura da valores del mismo intervalo. Si
+// la CPU (o la máquina virtual) no tiene alguno, sigo con los que abrieron.
+// Solo cuenta el hilo que llama; los workers abren su propio grupo.
+class PerfCounterGroup {
+public:
+    PerfCounterGroup() : leader(-1), opened(0) {
+        for (int i = 0; i < PERF_COUNTER_COUNT; ++i) fds[i] = -1;
+        memset(slot, -1, sizeof(slot));
+#if BREAKOUT_PERF_EVENTS
+        const Uint32 types[PERF_COUNTER_COUNT] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+        const Uint64 configs[PERF_COUNTER_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[i];
+            attr.config = configs[i];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.disabled = leader < 0 ? 1 : 0; // el líder arranca todo el grupo
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+            if (fd < 0) continue;
+            if (leader < 0) leader = fd;
+            fds[i] = fd;
+            slot[i] = opened++;
+        }
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    ~PerfCounterGroup() {
+#if BREAKOUT_PERF_EVENTS
+        for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+            if (fds[i] >= 0) close(fds[i]);
+        }
+#endif
+    }
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool ok() const { return leader >= 0; }
+    bool has(PerfCounter counter) const { return slot[counter] >= 0; }
+
+    // Una sola llamada a read() para todo el grupo: { nr, valor[nr] }
+    bool read(PerfSample& sample) const {
+        memset(&sample, 0, sizeof(sample));
+#if BREAKOUT_PERF_EVENTS
+        if (leader < 0) return false;
+        Uint64 buffer[1 + PERF_COUNTER_COUNT];
+        if (::read(leader, buffer, sizeof(buffer)) < static_cast<ssize_t>(sizeof(Uint64) * (1 + opened))) return false;
+        for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+            if (slot[i] >= 0) sample.values[i] = buffer[1 + slot[i]];
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    int leader;
+    int fds[PERF_COUNTER_COUNT];
+    int slot[PERF_COUNTER_COUNT]; // posición en la lectura del grupo, -1 si no abrió
+    int opened;
+};
+
+// Totales de una zona en un hilo
+struct PerfZoneTotals {
+    const char* name; // literal, se compara por puntero
+    Uint64 calls, entities;
+    Uint64 values[PERF_COUNTER_COUNT];
+};
+
+struct PerfThread {
+    PerfCounterGroup group;
+    std::vector<PerfZoneTotals> zones;
+
+    PerfThread() { zones.reserve(16); }
+
+    void add(const char* name, const PerfSample& begin, const PerfSample& end, Uint64 entities) {
+        PerfZoneTotals* zone = nullptr;
+        for (auto& z : zones) {
+            if (z.name == name) zone = &z;
+        }
+        if (!zone) {
+            zones.push_back({ name, 0, 0, {} });
+            zone = &zones.back();
+        }
+        ++zone->calls;
+        zone->entities += entities;
+        for (int i = 0; i < PERF_COUNTER_COUNT; ++i) zone->values[i] += end.values[i] - begin.values[i];
+    }
+};
+
+// Colector de contadores por zona. Cada hilo abre su grupo la primera vez que
+// entra en una zona medida; al final se suman los hilos y se informa IPC y
+// fallos por entidad procesada. Sin Linux (o sin permiso, ver
+// /proc/sys/kernel/perf_event_paranoid) las zonas no hacen nada.
+class PerfCounters {
+public:
+    PerfCounters() : active(false) { lock = SDL_CreateMutex(); }
+
+    void start() {
+#if BREAKOUT_PERF_EVENTS
+        active = true;
+        if (!thread()) {
+            printf("perf_event_open no disponible: %s\n", strerror(errno));
+            active = false;
+        }
+#else
+        printf("Los contadores de hardware solo estan en Linux\n");
+#endif
+    }
+
+    bool isActive() const { return active; }
+
+    // Grupo del hilo actual, nullptr si no se pudo abrir
+    PerfThread* thread() {
+        static thread_local PerfThread* current = nullptr;
+        static thread_local bool tried = false;
+        if (!tried) {
+            tried = true;
+            PerfThread* t = new PerfThread();
+            if (t->group.ok()) {
+                SDL_LockMutex(lock);
+                threads.push_back(t);
+                SDL_UnlockMutex(lock);
+                current = t;
+            } else {
+                delete t;
+            }
+        }
+        return current;
+    }
+
+    void printReport() {
+        if (!active) return;
+        std::vector<PerfZoneTotals> zones;
+        bool available[PERF_COUNTER_COUNT] = {};
+        SDL_LockMutex(lock);
+        for (PerfThread* t : threads) {
+            for (int i = 0; i < PERF_COUNTER_COUNT; ++i) available[i] |= t->group.has(static_cast<PerfCounter>(i));
+            for (const auto& z : t->zones) {
+                bool merged = false;
+                for (auto& m : zones) {
+                    if (strcmp(m.name, z.name) == 0) {
+                        m.calls += z.calls;
+                        m.entities += z.entities;
+                        for (int i = 0; i < PERF_COUNTER_COUNT; ++i) m.values[i] += z.values[i];
+                        merged = true;
+                    }
+                }
+                if (!merged) zones.push_back(z);
+            }
+        }
+        SDL_UnlockMutex(lock);
+
+        printf("Contadores de hardware (%zu hilos):", threads.size());
+        for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+            if (!available[i]) printf(" sin %s", PERF_COUNTER_NAMES[i]);
+        }
+        printf("\n%-12s %8s %10s %14s %6s %12s %12s %12s %12s\n", "zona", "llamadas", "entidades", "ciclos/llamada", "IPC",
+               "ciclos/ent", "L1D/ent", "LLC/ent", "saltos/ent");
+        for (const auto& z : zones) {
+            double calls = z.calls ? static_cast<double>(z.calls) : 1.0;
+            double entities = z.entities ? static_cast<double>(z.entities) : 1.0;
+            double cycles = static_cast<double>(z.values[PERF_CYCLES]);
+            printf("%-12s %8llu %10.1f %14.0f %6.2f %12.1f %12.3f %12.3f %12.3f\n", z.name,
+                   static_cast<unsigned long long>(z.calls), z.entities / calls, cycles / calls,
+                   cycles > 0.0 ? z.values[PERF_INSTRUCTIONS] / cycles : 0.0, cycles / entities,
+                   z.values[PERF_L1D_MISSES] / entities, z.values[PERF_LLC_MISSES] / entities,
+                   z.values[PERF_BRANCH_MISSES] / entities);
+        }
+    }
+
+private:
+    bool active;
+    SDL_mutex* lock;
+    std::vector<PerfThread*> threads; // viven hasta el final del programa
+};
+
+inline PerfCounters& perfCounters() {
+    static PerfCounters instance;
+    return instance;
+}
+
+// Lee el grupo del hilo al entrar y al salir del bloque; entities es cuántas
+// entidades procesa la zona, para normalizar los fallos
+class PerfScope {
+public:
+    PerfScope(const char* name, size_t entities) : name(name), entities(entities), thread(nullptr) {
+        if (!perfCounters().isActive()) return;
+        thread = perfCounters().thread();
+        if (thread) thread->group.read(begin);
+    }
+
+    ~PerfScope() {
+        if (!thread) return;
+        PerfSample end;
+        thread->group.read(end);
+        thread->add(name, begin, end, entities);
+    }
+
+private:
+    const char* name;
+    Uint64 entities;
+    PerfThread* thread;
+    PerfSample begin;
+};
+
+// Como PROFILE_ZONE, desaparece con -DBREAKOUT_PROFILE=0
+#if BREAKOUT_PROFILE
+#define PERF_ZONE(name, entities) PerfScope PROFILE_CONCAT(perfZone, __LINE__)(name, entities)
+#else
+#define PERF_ZONE(name, entities) ((void)0)
+#endif
+
+#endif
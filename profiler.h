@@ -0,0 +1,272 @@
+#ifndef BREAKOUT_PROFILER_H
+#define BREAKOUT_PROFILER_H
+
+#include "inc/SDL.h"
+#include "allocation.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Con -DBREAKOUT_PROFILE=0 las zonas desaparecen al compilar
+#ifndef BREAKOUT_PROFILE
+#define BREAKOUT_PROFILE 1
+#endif
+
+const int PROFILE_EVENTS_PER_THREAD = 1 << 16; // potencia de dos
+
+struct ProfileEvent {
+    const char* name; // literal, no se copia
+    Uint64 begin, end;
+    Uint32 allocations, bytes; // asignaciones dentro de la zona (incluye las anidadas)
+};
+
+// Asignaciones acumuladas de una zona; steady cuenta solo las de estado estable
+struct ZoneAllocations {
+    const char* name;
+    Uint64 allocations, bytes, steadyAllocations;
+};
+
+// Eventos de un hilo en un anillo: solo escribe su dueño y se pisan los más
+// viejos, así siempre está la historia reciente para exportar alrededor de un hitch
+struct ProfileBuffer {
+    SDL_threadID thread;
+    std::string threadName;
+    std::vector<ProfileEvent> events;
+    SDL_atomic_t written;
+    std::vector<ZoneAllocations> zoneAllocations; // solo las zonas que asignaron
+
+    ProfileBuffer(SDL_threadID thread, const char* name) : thread(thread), threadName(name), events(PROFILE_EVENTS_PER_THREAD) {
+        SDL_AtomicSet(&written, 0);
+        zoneAllocations.reserve(64);
+    }
+
+    void push(const ProfileEvent& e) {
+        Uint32 w = static_cast<Uint32>(SDL_AtomicGet(&written));
+        events[w & (PROFILE_EVENTS_PER_THREAD - 1)] = e;
+        SDL_AtomicSet(&written, static_cast<int>(w + 1));
+    }
+
+    void addAllocations(const ProfileEvent& e, bool steady) {
+        for (auto& zone : zoneAllocations) {
+            if (zone.name == e.name) {
+                zone.allocations += e.allocations;
+                zone.bytes += e.bytes;
+                if (steady) zone.steadyAllocations += e.allocations;
+                return;
+            }
+        }
+        zoneAllocations.push_back({ e.name, e.allocations, e.bytes, steady ? e.allocations : 0 });
+    }
+};
+
+// Perfilador por zonas. Cada hilo registra su buffer la primera vez que cierra
+// una zona; el hilo principal marca los frames y, si un frame dura más del
+// doble del promedio reciente, espera la mitad de la ventana y escribe los N
+// frames alrededor del hitch en formato Chrome Trace (se abre con Perfetto).
+// Si no hubo hitch, al terminar se escriben los últimos N frames.
+class Profiler {
+public:
+    Profiler() : active(false), mainThread(0), windowFrames(120), frameIndex(0), averageFrameTicks(0.0),
+                 pendingFrames(-1), hitchFrame(0), written(false) {
+        lock = SDL_CreateMutex();
+        origin = SDL_GetPerformanceCounter();
+        SDL_AtomicSet(&steady, 0);
+    }
+
+    // Antes de crear hilos. Sin tracePath se registran las zonas (para contar
+    // asignaciones) pero no se escribe ninguna traza.
+    void start(const char* tracePath, int frames) {
+        path = tracePath ? tracePath : "";
+        mainThread = SDL_ThreadID();
+        windowFrames = frames > 0 ? frames : 120;
+        frameStarts.assign(windowFrames + 1, 0);
+        active = true;
+    }
+
+    bool isActive() const { return active; }
+
+    void record(const ProfileEvent& e) {
+        static thread_local ProfileBuffer* buffer = nullptr;
+        if (!buffer) buffer = registerThread();
+        buffer->push(e);
+        if (e.allocations > 0) buffer->addAllocations(e, SDL_AtomicGet(&steady) != 0);
+    }
+
+    // A partir de acá las asignaciones de las zonas cuentan como de estado estable
+    void setSteady() { SDL_AtomicSet(&steady, 1); }
+
+    // Zonas que asignaron, sumando todos los hilos (al final de la corrida)
+    void printAllocations() {
+        std::vector<ZoneAllocations> zones;
+        SDL_LockMutex(lock);
+        for (ProfileBuffer* b : buffers) {
+            for (const auto& z : b->zoneAllocations) {
+                bool merged = false;
+                for (auto& m : zones) {
+                    if (strcmp(m.name, z.name) == 0) {
+                        m.allocations += z.allocations;
+                        m.bytes += z.bytes;
+                        m.steadyAllocations += z.steadyAllocations;
+                        merged = true;
+                    }
+                }
+                if (!merged) zones.push_back(z);
+            }
+        }
+        SDL_UnlockMutex(lock);
+        for (const auto& z : zones) {
+            printf("  %-24s %8llu asignaciones %10llu bytes, %llu en estado estable\n", z.name,
+                   static_cast<unsigned long long>(z.allocations), static_cast<unsigned long long>(z.bytes),
+                   static_cast<unsigned long long>(z.steadyAllocations));
+        }
+    }
+
+    // Hilo principal, al empezar cada frame
+    void beginFrame() {
+        if (!active) return;
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (frameIndex > 0) {
+            double frameTicks = static_cast<double>(now - frameStarts[(frameIndex - 1) % frameStarts.size()]);
+            if (averageFrameTicks > 0.0 && frameTicks > 2.0 * averageFrameTicks && pendingFrames < 0 && !written) {
+                hitchFrame = frameIndex - 1;
+                pendingFrames = windowFrames / 2;
+            }
+            averageFrameTicks = averageFrameTicks > 0.0 ? averageFrameTicks * 0.95 + frameTicks * 0.05 : frameTicks;
+        }
+        if (pendingFrames == 0) {
+            if (!path.empty()) printf("Hitch en el frame %llu, ", static_cast<unsigned long long>(hitchFrame));
+            writeLastFrames(now);
+            pendingFrames = -1;
+            written = true;
+        } else if (pendingFrames > 0) {
+            --pendingFrames;
+        }
+        frameStarts[frameIndex % frameStarts.size()] = now;
+        ++frameIndex;
+    }
+
+    // Escribo ya los últimos N frames (tecla F11)
+    void dumpNow() {
+        if (active) writeLastFrames(SDL_GetPerformanceCounter());
+    }
+
+    void finish() {
+        if (active && !written && frameIndex > 0) writeLastFrames(SDL_GetPerformanceCounter());
+        written = true;
+    }
+
+private:
+    ProfileBuffer* registerThread() {
+        SDL_LockMutex(lock);
+        SDL_threadID id = SDL_ThreadID();
+        buffers.push_back(new ProfileBuffer(id, id == mainThread ? "main" : "thread"));
+        ProfileBuffer* buffer = buffers.back();
+        SDL_UnlockMutex(lock);
+        return buffer;
+    }
+
+    void writeLastFrames(Uint64 now) {
+        if (path.empty()) return;
+        Uint64 frames = frameIndex < static_cast<Uint64>(windowFrames) ? frameIndex : windowFrames;
+        Uint64 from = frames ? frameStarts[(frameIndex - frames) % frameStarts.size()] : origin;
+        if (writeTrace(from, now)) {
+            printf("traza de %llu frames en %s\n", static_cast<unsigned long long>(frames), path.c_str());
+        }
+    }
+
+    // Eventos completos ("ph":"X") con microsegundos desde que arrancó el perfilador
+    bool writeTrace(Uint64 from, Uint64 to) {
+        FILE* out = fopen(path.c_str(), "w");
+        if (!out) return false;
+        const double usPerTick = 1e6 / SDL_GetPerformanceFrequency();
+        fprintf(out, "{\"traceEvents\":[");
+        bool first = true;
+
+        SDL_LockMutex(lock);
+        for (size_t t = 0; t < buffers.size(); ++t) {
+            ProfileBuffer& b = *buffers[t];
+            fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s %zu\"}}",
+                    first ? "" : ",", t, b.threadName.c_str(), t);
+            first = false;
+
+            // El dueño puede seguir escribiendo: descarto lo que pudo pisarse mientras copiaba
+            Uint32 end = static_cast<Uint32>(SDL_AtomicGet(&b.written));
+            Uint32 begin = end > PROFILE_EVENTS_PER_THREAD ? end - PROFILE_EVENTS_PER_THREAD : 0;
+            std::vector<ProfileEvent> copy;
+            for (Uint32 i = begin; i != end; ++i) copy.push_back(b.events[i & (PROFILE_EVENTS_PER_THREAD - 1)]);
+            Uint32 after = static_cast<Uint32>(SDL_AtomicGet(&b.written));
+            Uint32 overwritten = after - end;
+
+            for (size_t i = overwritten; i < copy.size(); ++i) {
+                const ProfileEvent& e = copy[i];
+                if (e.end < from || e.begin > to) continue;
+                fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f",
+                        e.name, t, (e.begin - origin) * usPerTick, (e.end - e.begin) * usPerTick);
+                if (e.allocations) fprintf(out, ",\"args\":{\"allocations\":%u,\"bytes\":%u}", e.allocations, e.bytes);
+                fprintf(out, "}");
+            }
+        }
+        SDL_UnlockMutex(lock);
+
+        fprintf(out, "\n]}\n");
+        fclose(out);
+        return true;
+    }
+
+    bool active;
+    std::string path;
+    SDL_threadID mainThread;
+    int windowFrames;
+    SDL_mutex* lock;
+    std::vector<ProfileBuffer*> buffers; // viven hasta el final del programa
+    Uint64 origin;
+    SDL_atomic_t steady;
+
+    // Solo los toca el hilo principal
+    std::vector<Uint64> frameStarts;
+    Uint64 frameIndex;
+    double averageFrameTicks;
+    int pendingFrames;
+    Uint64 hitchFrame;
+    bool written;
+};
+
+inline Profiler& profiler() {
+    static Profiler instance;
+    return instance;
+}
+
+// Mide desde que se construye hasta que sale del bloque
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : name(name), begin(0), allocations(0), bytes(0) {
+        if (!profiler().isActive()) return;
+        const AllocationCounts& counts = threadAllocations();
+        allocations = counts.count;
+        bytes = counts.bytes;
+        begin = SDL_GetPerformanceCounter();
+    }
+
+    ~ProfileScope() {
+        if (!begin) return;
+        Uint64 end = SDL_GetPerformanceCounter();
+        const AllocationCounts& counts = threadAllocations();
+        profiler().record({ name, begin, end, static_cast<Uint32>(counts.count - allocations), static_cast<Uint32>(counts.bytes - bytes) });
+    }
+
+private:
+    const char* name;
+    Uint64 begin;
+    Uint64 allocations, bytes;
+};
+
+#if BREAKOUT_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileScope PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef BREAKOUT_RENDER_COMMANDS_H
+#define BREAKOUT_RENDER_COMMANDS_H
+
+#include "inc/SDL.h"
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Capas de dibujo, de atrás hacia adelante
+enum RenderLayer { LAYER_BLOCKS = 0, LAYER_PADDLES = 1, LAYER_BALLS = 2 };
+
+// Comando de dibujo POD: un rectángulo sólido o con textura. La clave ordena
+// por capa, después por textura (menos cambios de estado) y al final por orden
+// de emisión, así el resultado no depende de qué hilo grabó cada comando.
+struct RenderCommand {
+    Uint64 key;
+    SDL_Rect rect;
+    SDL_Color color;
+    Uint16 texture; // 0: rectángulo sólido
+};
+
+inline Uint64 makeSortKey(Uint8 layer, Uint16 texture, Uint32 sequence) {
+    return (static_cast<Uint64>(layer) << 48) | (static_cast<Uint64>(texture) << 32) | sequence;
+}
+
+inline Uint32 packColor(SDL_Color c) {
+    return (static_cast<Uint32>(c.a) << 24) | (static_cast<Uint32>(c.r) << 16) | (static_cast<Uint32>(c.g) << 8) | c.b;
+}
+
+// Listas de comandos, una por worker para grabar sin locks, que se juntan y
+// ordenan por clave con radix sort antes de reproducirlas en un solo hilo
+class RenderCommandList {
+public:
+    void setWorkers(int workers) { lists.resize(workers); }
+    int workers() const { return static_cast<int>(lists.size()); }
+
+    std::vector<RenderCommand>& workerList(int worker) { return lists[worker]; }
+
+    // Reservo lugar para count comandos, así merge() no asigna mientras no se pase
+    void reserve(size_t count) {
+        for (auto& list : lists) list.reserve(count);
+        merged.reserve(count);
+        scratch.reserve(count);
+    }
+
+    void clear() {
+        for (auto& list : lists) list.clear();
+        merged.clear();
+    }
+
+    // Concateno las listas de los workers y ordeno por clave
+    void merge() {
+        size_t total = 0;
+        for (const auto& list : lists) total += list.size();
+        merged.resize(total);
+        scratch.resize(total);
+
+        size_t offset = 0;
+        for (const auto& list : lists) {
+            if (!list.empty()) memcpy(&merged[offset], list.data(), list.size() * sizeof(RenderCommand));
+            offset += list.size();
+        }
+        radixSort();
+    }
+
+    const RenderCommand* data() const { return merged.data(); }
+    int size() const { return static_cast<int>(merged.size()); }
+    const RenderCommand* begin() const { return merged.data(); }
+    const RenderCommand* end() const { return merged.data() + merged.size(); }
+
+private:
+    // LSD de 8 bits por pasada, estable. Las pasadas donde todas las claves
+    // comparten el dígito (capa o textura constantes) se saltan.
+    void radixSort() {
+        const size_t n = merged.size();
+        if (n < 2) return;
+
+        size_t histogram[8][256];
+        memset(histogram, 0, sizeof(histogram));
+        for (size_t i = 0; i < n; ++i) {
+            Uint64 key = merged[i].key;
+            for (int pass = 0; pass < 8; ++pass) {
+                ++histogram[pass][(key >> (pass * 8)) & 0xFF];
+            }
+        }
+
+        RenderCommand* src = merged.data();
+        RenderCommand* dst = scratch.data();
+        for (int pass = 0; pass < 8; ++pass) {
+            size_t* counts = histogram[pass];
+            if (counts[(src[0].key >> (pass * 8)) & 0xFF] == n) continue;
+
+            size_t sum = 0;
+            for (int b = 0; b < 256; ++b) {
+                size_t c = counts[b];
+                counts[b] = sum;
+                sum += c;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                dst[counts[(src[i].key >> (pass * 8)) & 0xFF]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+        if (src != merged.data()) merged.swap(scratch);
+    }
+
+    std::vector<std::vector<RenderCommand>> lists;
+    std::vector<RenderCommand> merged;
+    std::vector<RenderCommand> scratch;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef BREAKOUT_RENDER_SNAPSHOT_H
+#define BREAKOUT_RENDER_SNAPSHOT_H
+
+#include "inc/SDL.h"
+#include "profiler.h"
+#include "render_commands.h"
+#include "workers.h"
+#include <vector>
+
+// Lo que el render necesita de una entidad, copiado de la simulación
+struct SnapshotItem {
+    float x, y;
+    int w, h;
+    SDL_Color color;
+    Uint16 sprite;  // 0: rectángulo sólido
+    Uint8 layer;
+    bool visible;
+};
+
+// Un bloque que se rompió en la simulación, para efectos visuales
+struct BreakEvent {
+    float x, y;
+    SDL_Color color;
+};
+
+// Foto inmutable del mundo que publica la simulación para el render
+struct RenderSnapshot {
+    Uint64 tick = 0;         // tick de simulación que la produjo
+    Uint64 publishedAt = 0;  // SDL_GetPerformanceCounter() al publicarla
+    int score = 0;
+    int blocksLeft = 0;
+    std::vector<SnapshotItem> items;
+    std::vector<BreakEvent> events; // bloques rotos desde la foto anterior que leyó el render
+};
+
+// Triple buffer sin locks para un productor y un consumidor. El productor
+// escribe en su buffer y lo intercambia con el "listo" con SDL_AtomicSetPtr;
+// el bit bajo del puntero marca que hay datos nuevos. El consumidor solo
+// intercambia cuando ve ese bit, así ninguno espera nunca al otro.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : back(&buffers[0]), front(&buffers[1]), ready(&buffers[2]) {
+        static_assert(alignof(T) >= 2, "el bit bajo del puntero marca datos nuevos");
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Lado productor
+    T& writeBuffer() { return *back; }
+
+    // Devuelve true si el buffer que vuelve al productor nunca llegó a leerse,
+    // para que pueda conservar lo que no se puede perder (eventos)
+    bool publish() {
+        void* old = SDL_AtomicSetPtr(&ready, tag(back));
+        back = untag(old);
+        return (reinterpret_cast<uintptr_t>(old) & 1) != 0;
+    }
+
+    // Lado consumidor: devuelve true si había una publicación nueva
+    bool acquire() {
+        if (!(reinterpret_cast<uintptr_t>(SDL_AtomicGetPtr(&ready)) & 1)) {
+            return false;
+        }
+        void* old = SDL_AtomicSetPtr(&ready, front);
+        front = untag(old);
+        return true;
+    }
+
+    const T& readBuffer() const { return *front; }
+
+private:
+    static void* tag(T* p) { return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(p) | 1); }
+    static T* untag(void* p) { return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(1)); }
+
+    T buffers[3];
+    T* back;
+    T* front;
+    void* ready;
+};
+
+// Grabo los comandos de un rango de entidades de la foto. El índice de la
+// entidad es el orden de emisión, así los rangos son independientes.
+inline void recordRenderCommands(const RenderSnapshot& snapshot, int begin, int end, std::vector<RenderCommand>& out) {
+    out.clear();
+    for (int i = begin; i < end; ++i) {
+        const SnapshotItem& item = snapshot.items[i];
+        if (item.visible) {
+            RenderCommand cmd;
+            cmd.key = makeSortKey(item.layer, item.sprite, static_cast<Uint32>(i));
+            cmd.rect = { static_cast<int>(item.x), static_cast<int>(item.y), item.w, item.h };
+            cmd.color = item.color;
+            cmd.texture = item.sprite;
+            out.push_back(cmd);
+        }
+    }
+}
+
+// Por debajo de esta cantidad de entidades no vale la pena despertar workers
+const int PARALLEL_RECORD_MIN_ITEMS = 4096;
+
+// Genero los comandos del frame: cada worker graba un rango disjunto de la
+// foto en su propia lista, y después se juntan y ordenan por clave
+inline void buildRenderCommands(const RenderSnapshot& snapshot, RenderCommandList& commands, WorkerPool* pool) {
+    struct RecordJob {
+        const RenderSnapshot* snapshot;
+        RenderCommandList* commands;
+        int parts;
+
+        static void run(void* data, int worker) {
+            PROFILE_ZONE("render.record.worker");
+            RecordJob* job = static_cast<RecordJob*>(data);
+            const int count = static_cast<int>(job->snapshot->items.size());
+            int begin = static_cast<int>(static_cast<long long>(count) * worker / job->parts);
+            int end = static_cast<int>(static_cast<long long>(count) * (worker + 1) / job->parts);
+            recordRenderCommands(*job->snapshot, begin, end, job->commands->workerList(worker));
+        }
+    };
+
+    const int count = static_cast<int>(snapshot.items.size());
+    commands.clear();
+    if (pool && count >= PARALLEL_RECORD_MIN_ITEMS && commands.workers() >= pool->size()) {
+        RecordJob job = { &snapshot, &commands, pool->size() };
+        pool->run(RecordJob::run, &job);
+    } else {
+        recordRenderCommands(snapshot, 0, count, commands.workerList(0));
+    }
+    commands.merge();
+}
+
+#endif
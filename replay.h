@@ -0,0 +1,301 @@
+#ifndef BREAKOUT_REPLAY_H
+#define BREAKOUT_REPLAY_H
+
+#include "inc/SDL.h"
+#include "breakout.h"
+#include "headless.h"
+#include "state_hash.h"
+#include "state_stream.h"
+#include "varint.h"
+#include <cstring>
+#include <vector>
+
+// Formato de grabación: cabecera "BKREP2" + semilla, pantallas del nivel,
+// ticks, puntaje, bloques restantes y estado final (estos cuatro se escriben
+// al cerrar, para verificar la reproducción), y después bloques de
+// Uint32 (bytes << 1 | es de hashes) seguido de los bytes. Los de entrada
+// tienen tramos de ticks con la misma entrada y el mismo dT:
+//   varint (largo << 3 | cambia dT << 2 | botones)
+//   si cambia dT: varint (bits del dT XOR bits del dT anterior)
+// y los de hashes, el hash del mundo después de cada tick (WorldHasher) en
+// Uint32, en orden, para encontrar el primer tick en que la reproducción se
+// separa. Los dos se escriben cuando se llena su buffer, así grabar no
+// asigna memoria después del primer tick. Las grabaciones "BKREP1" tienen
+// solo los tramos, sin bloques ni hashes, y se siguen leyendo.
+const char REPLAY_MAGIC[8] = { 'B', 'K', 'R', 'E', 'P', '2', 0, 0 };
+const char REPLAY_MAGIC_V1[8] = { 'B', 'K', 'R', 'E', 'P', '1', 0, 0 };
+const Sint64 REPLAY_RESULT_OFFSET = 16; // donde empiezan ticks, puntaje, bloques y estado
+
+struct ReplayHeader {
+    Uint32 seed;
+    Uint32 levelScreens;
+    Uint64 ticks;
+    Sint32 score;
+    Sint32 blocksLeft;
+    Uint32 status; // GameStatus al terminar
+};
+
+// Graba la entrada y el dT de cada tick, y el hash del mundo. Junta los ticks
+// iguales en un solo tramo y escribe con SDL_RWops de a bloques de 4 KB.
+class ReplayRecorder {
+public:
+    ReplayRecorder(const char* path, Uint32 seed, int levelScreens)
+        : runInput(0), runBits(0), runLength(0), previousBits(0), ticks(0) {
+        buffer.reserve(2 * FLUSH_BYTES);
+        hashBuffer.reserve(FLUSH_BYTES);
+        file = SDL_RWFromFile(path, "wb");
+        if (!file) return;
+        SDL_RWwrite(file, REPLAY_MAGIC, 1, sizeof(REPLAY_MAGIC));
+        SDL_WriteLE32(file, seed);
+        SDL_WriteLE32(file, static_cast<Uint32>(levelScreens));
+        writeResult({ seed, static_cast<Uint32>(levelScreens), 0, 0, 0, 0 });
+    }
+
+    ~ReplayRecorder() {
+        if (file) SDL_RWclose(file);
+    }
+
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+    bool ok() const { return file != nullptr; }
+    Uint64 getTicks() const { return ticks; }
+
+    void record(Uint32 input, float dT) {
+        Uint32 bits = floatBits(dT);
+        if (runLength > 0 && input == runInput && bits == runBits) {
+            ++runLength;
+        } else {
+            flushRun();
+            runInput = input;
+            runBits = bits;
+            runLength = 1;
+        }
+        ++ticks;
+    }
+
+    // Hash del mundo después del update() del tick que se acaba de grabar
+    void recordHash(const ECS& ecs) {
+        Uint32 h = hasher.hash(ecs);
+        for (int b = 0; b < 4; ++b) hashBuffer.push_back(static_cast<Uint8>(h >> (8 * b)));
+        if (hashBuffer.size() >= FLUSH_BYTES) writeHashes();
+    }
+
+    // Escribo el último tramo, los hashes y el resultado de la partida en la cabecera
+    void finish(const ECS& ecs, GameStatus status) {
+        if (!file) return;
+        flushRun();
+        writeBuffer();
+        writeHashes();
+        ReplayHeader result = { 0, 0, ticks, ecs.score, ecs.blocksLeft, static_cast<Uint32>(status) };
+        Sint64 size = SDL_RWtell(file);
+        SDL_RWseek(file, REPLAY_RESULT_OFFSET, RW_SEEK_SET);
+        writeResult(result);
+        SDL_RWclose(file);
+        file = nullptr;
+        printf("Grabacion: %llu ticks en %lld bytes\n", static_cast<unsigned long long>(ticks), static_cast<long long>(size));
+    }
+
+private:
+    static const size_t FLUSH_BYTES = 4096;
+
+    void flushRun() {
+        if (runLength == 0) return;
+        bool changed = runBits != previousBits;
+        appendVarint(buffer, (runLength << 3) | (changed ? 4 : 0) | (runInput & 3));
+        if (changed) appendVarint(buffer, runBits ^ previousBits);
+        previousBits = runBits;
+        runLength = 0;
+        if (buffer.size() >= FLUSH_BYTES) writeBuffer();
+    }
+
+    void writeBlock(std::vector<Uint8>& block, bool hashes) {
+        if (file && !block.empty()) {
+            SDL_WriteLE32(file, static_cast<Uint32>(block.size() << 1 | (hashes ? 1 : 0)));
+            SDL_RWwrite(file, block.data(), 1, block.size());
+        }
+        block.clear();
+    }
+
+    void writeBuffer() { writeBlock(buffer, false); }
+    void writeHashes() { writeBlock(hashBuffer, true); }
+
+    void writeResult(const ReplayHeader& h) {
+        SDL_WriteLE64(file, h.ticks);
+        SDL_WriteLE32(file, static_cast<Uint32>(h.score));
+        SDL_WriteLE32(file, static_cast<Uint32>(h.blocksLeft));
+        SDL_WriteLE32(file, h.status);
+    }
+
+    SDL_RWops* file;
+    std::vector<Uint8> buffer;
+    Uint32 runInput, runBits;
+    Uint64 runLength;
+    Uint32 previousBits;
+    Uint64 ticks;
+    WorldHasher hasher;
+    std::vector<Uint8> hashBuffer; // 4 bytes por tick, unos 850 KB por hora a 60 Hz
+};
+
+// Lee una grabación entera a memoria y la devuelve de a un tick
+class ReplayReader {
+public:
+    bool load(const char* path) {
+        SDL_RWops* file = SDL_RWFromFile(path, "rb");
+        if (!file) return false;
+        char magic[sizeof(REPLAY_MAGIC)];
+        bool ok = SDL_RWread(file, magic, 1, sizeof(magic)) == sizeof(magic);
+        bool v1 = ok && memcmp(magic, REPLAY_MAGIC_V1, sizeof(magic)) == 0;
+        ok = ok && (v1 || memcmp(magic, REPLAY_MAGIC, sizeof(magic)) == 0);
+        hashes.clear();
+        if (ok) {
+            header.seed = SDL_ReadLE32(file);
+            header.levelScreens = SDL_ReadLE32(file);
+            header.ticks = SDL_ReadLE64(file);
+            header.score = static_cast<Sint32>(SDL_ReadLE32(file));
+            header.blocksLeft = static_cast<Sint32>(SDL_ReadLE32(file));
+            header.status = SDL_ReadLE32(file);
+            Sint64 start = SDL_RWtell(file);
+            Sint64 size = SDL_RWsize(file);
+            std::vector<Uint8> body(static_cast<size_t>(size > start ? size - start : 0));
+            ok = body.empty() || SDL_RWread(file, body.data(), 1, body.size()) == body.size();
+            data.clear();
+            if (ok && v1) data.swap(body);
+            else if (ok) ok = splitBlocks(body);
+        }
+        SDL_RWclose(file);
+        rewind();
+        return ok;
+    }
+
+    const ReplayHeader& getHeader() const { return header; }
+
+    void rewind() {
+        cursor = data.data();
+        runLeft = 0;
+        bits = 0;
+        input = 0;
+        tick = 0;
+        firstMismatch = 0;
+    }
+
+    // false al terminar la grabación
+    bool next(Uint32& tickInput, float& dT) {
+        if (runLeft == 0) {
+            Uint64 code, delta;
+            if (!readVarint(cursor, data.data() + data.size(), code)) return false;
+            if (code & 4) {
+                if (!readVarint(cursor, data.data() + data.size(), delta)) return false;
+                bits ^= static_cast<Uint32>(delta);
+            }
+            input = static_cast<Uint32>(code & 3);
+            runLeft = code >> 3;
+            if (runLeft == 0) return false;
+        }
+        --runLeft;
+        ++tick;
+        tickInput = input;
+        dT = bitsFloat(bits);
+        return true;
+    }
+
+    Uint64 getTick() const { return tick; }
+
+    bool hasHashes() const { return !hashes.empty(); }
+    const std::vector<Uint32>& getHashes() const { return hashes; }
+
+    // Comparo el mundo después del tick que devolvió next() con el grabado;
+    // me quedo con el primero que no coincide
+    void verify(const ECS& ecs) {
+        if (tick == 0 || tick > hashes.size() || firstMismatch != 0) return;
+        Uint32 h = hasher.hash(ecs);
+        if (h != hashes[tick - 1]) {
+            firstMismatch = tick;
+            mismatchHash = h;
+        }
+    }
+
+    // Primer tick (desde 1) cuyo hash no coincide, 0 si todos coinciden
+    Uint64 getFirstMismatch() const { return firstMismatch; }
+
+    void printMismatch() const {
+        if (firstMismatch == 0) return;
+        printf("El mundo se separa de la grabacion en el tick %llu (cuenta desde 0): hash %08x, grabado %08x\n",
+               static_cast<unsigned long long>(firstMismatch - 1), mismatchHash, hashes[firstMismatch - 1]);
+    }
+
+private:
+    // Separo los bloques de entrada y de hashes de una grabación BKREP2
+    bool splitBlocks(const std::vector<Uint8>& body) {
+        size_t p = 0;
+        while (p < body.size()) {
+            if (body.size() - p < 4) return false;
+            Uint32 code = static_cast<Uint32>(body[p]) | static_cast<Uint32>(body[p + 1]) << 8 |
+                          static_cast<Uint32>(body[p + 2]) << 16 | static_cast<Uint32>(body[p + 3]) << 24;
+            p += 4;
+            size_t bytes = code >> 1;
+            if (bytes > body.size() - p) return false;
+            const Uint8* block = body.data() + p;
+            if (code & 1) {
+                if (bytes % 4 != 0) return false;
+                for (size_t i = 0; i < bytes; i += 4) {
+                    hashes.push_back(static_cast<Uint32>(block[i]) | static_cast<Uint32>(block[i + 1]) << 8 |
+                                     static_cast<Uint32>(block[i + 2]) << 16 | static_cast<Uint32>(block[i + 3]) << 24);
+                }
+            } else {
+                data.insert(data.end(), block, block + bytes);
+            }
+            p += bytes;
+        }
+        return true;
+    }
+
+    ReplayHeader header = {};
+    std::vector<Uint8> data;
+    const Uint8* cursor = nullptr;
+    Uint64 runLeft = 0;
+    Uint32 bits = 0;
+    Uint32 input = 0;
+    Uint64 tick = 0;
+    std::vector<Uint32> hashes;
+    WorldHasher hasher;
+    Uint64 firstMismatch = 0;
+    Uint32 mismatchHash = 0;
+};
+
+// Inicializo el mundo como al grabar
+inline void startReplay(const ReplayReader& replay, ECS& ecs) {
+    srand(replay.getHeader().seed);
+    ecs = ECS();
+    initializeEntities(ecs, static_cast<int>(replay.getHeader().levelScreens));
+}
+
+// Reproduzco sin ventana y sin esperas, hasta el final o hasta que termine la
+// partida; con stream guardo además el estado de cada tick
+inline HeadlessResult replayHeadless(ReplayReader& replay, ECS& ecs, StateStreamWriter* stream = nullptr) {
+    HeadlessResult result = { GameStatus::Running, 0, 0.0, 0, 0 };
+    Uint64 start = SDL_GetPerformanceCounter();
+    Uint32 input;
+    float dT;
+    while (replay.next(input, dT)) {
+        applyInput(ecs, input);
+        result.status = update(ecs, dT);
+        replay.verify(ecs);
+        if (stream) stream->writeTick(ecs);
+        ++result.ticks;
+        if (result.status != GameStatus::Running) break;
+    }
+    result.seconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+    result.score = ecs.score;
+    result.blocksLeft = ecs.blocksLeft;
+    return result;
+}
+
+// ¿Terminó igual que cuando se grabó?
+inline bool replayMatches(const ReplayReader& replay, const HeadlessResult& result) {
+    const ReplayHeader& h = replay.getHeader();
+    return result.ticks == h.ticks && result.score == h.score && result.blocksLeft == h.blocksLeft &&
+           static_cast<Uint32>(result.status) == h.status && replay.getFirstMismatch() == 0;
+}
+
+#endif
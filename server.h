@@ -0,0 +1,236 @@
+#ifndef BREAKOUT_SERVER_H
+#define BREAKOUT_SERVER_H
+
+#include "inc/SDL.h"
+#include "breakout.h"
+#include "pacer.h"
+#include "telemetry.h"
+#include "workers.h"
+#include "world_snapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+// Un shard que se pasa del presupuesto tantos ticks seguidos empieza a cerrar partidas
+const int SHED_AFTER_TICKS = 30;
+
+// Latencia de los ticks de una partida, en nanosegundos
+struct MatchLatency {
+    Uint64 count = 0;
+    Uint64 sumNs = 0;
+    Uint32 maxNs = 0;
+
+    void add(Uint32 ns) {
+        ++count;
+        sumNs += ns;
+        if (ns > maxNs) maxNs = ns;
+    }
+
+    double meanNs() const { return count ? static_cast<double>(sumNs) / count : 0.0; }
+};
+
+// Una partida independiente: su propio mundo, con sus propios ids
+struct Match {
+    int id;
+    ECS ecs;
+    Uint64 ticks = 0;
+    Uint64 skippedTicks = 0; // ticks en que no le tocó correr por falta de presupuesto
+    int finished = 0;        // partidas terminadas (se reinicia en el lugar)
+    MatchLatency latency;
+};
+
+// Las partidas de un worker. Las crea y las reinicia el hilo del worker, así
+// su memoria sale de la arena de malloc de ese hilo y queda cerca de quien la
+// usa; en estado estable los ticks no asignan.
+struct Shard {
+    std::vector<Match*> matches;
+    int pendingCreate = 0;
+    int nextMatchId = 0;
+    size_t cursor = 0;          // por dónde empieza el próximo tick (round robin)
+    int overBudgetTicks = 0;    // ticks seguidos sin terminar todas las partidas
+    Uint64 skipped = 0;         // partidas salteadas en total
+    Uint64 shed = 0;            // partidas cerradas por sobrecarga
+    Uint64 finishedMatches = 0;
+    HdrHistogram matchTickNs;   // latencia de un tick de una partida
+    HdrHistogram shardTickUs;   // cuánto tardó el shard en su tick
+};
+
+// Servidor de muchas partidas sin ventana. Cada tick, a hz fijos, todos los
+// workers avanzan su shard: recorren sus partidas en round robin empezando
+// donde quedó el tick anterior y, si se les acaba el presupuesto del tick,
+// dejan el resto para el siguiente (así ninguna partida se queda siempre
+// afuera). Un shard que no llega a terminar SHED_AFTER_TICKS ticks seguidos
+// cierra sus partidas más nuevas hasta volver a entrar en el presupuesto.
+class MatchServer {
+public:
+    MatchServer(int matches, int threads, int hz, int levelScreens, double budgetFraction = 0.8)
+        : pool(threads), shards(pool.size()), hz(hz > 0 ? hz : 60), levelScreens(levelScreens), tick(0) {
+        const Uint64 freq = SDL_GetPerformanceFrequency();
+        period = freq / this->hz;
+        budget = static_cast<Uint64>(period * budgetFraction);
+        for (size_t s = 0; s < shards.size(); ++s) {
+            shards[s].pendingCreate = matches / static_cast<int>(shards.size()) + (static_cast<int>(s) < matches % static_cast<int>(shards.size()) ? 1 : 0);
+            shards[s].nextMatchId = static_cast<int>(s) << 24;
+        }
+        // Todas las partidas arrancan y se reinician desde la misma foto
+        ECS start;
+        initializeEntities(start, levelScreens);
+        levelStart.save(start);
+        pool.run(createJob, this);
+    }
+
+    ~MatchServer() {
+        for (auto& shard : shards) {
+            for (Match* m : shard.matches) delete m;
+        }
+    }
+
+    MatchServer(const MatchServer&) = delete;
+    MatchServer& operator=(const MatchServer&) = delete;
+
+    // Corro durante seconds segundos a ritmo fijo
+    void run(double seconds) {
+        const Uint64 freq = SDL_GetPerformanceFrequency();
+        const Uint64 margin = calibrateSleepOvershoot();
+        const Uint64 start = SDL_GetPerformanceCounter();
+        const Uint64 end = start + static_cast<Uint64>(seconds * freq);
+        Uint64 deadline = start;
+        lateTicks = 0;
+        while (SDL_GetPerformanceCounter() < end) {
+            tickStart = SDL_GetPerformanceCounter();
+            pool.run(shardJob, this);
+            Uint64 now = SDL_GetPerformanceCounter();
+            serverTickUs.record(elapsedUs(tickStart, now));
+            ++tick;
+
+            deadline += period;
+            if (now > deadline) {
+                ++lateTicks;
+                deadline = now; // atrasado: no intento recuperar
+            } else {
+                sleepUntil(deadline, margin);
+            }
+        }
+        elapsedSeconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(freq);
+    }
+
+    void printReport() const {
+        HdrHistogram matchTicks, shardTicks;
+        size_t live = 0;
+        Uint64 skipped = 0, shed = 0, finished = 0, matchTickCount = 0;
+        for (const auto& shard : shards) {
+            matchTicks.add(shard.matchTickNs);
+            shardTicks.add(shard.shardTickUs);
+            live += shard.matches.size();
+            skipped += shard.skipped;
+            shed += shard.shed;
+            finished += shard.finishedMatches;
+            matchTickCount += shard.matchTickNs.count();
+        }
+        printf("Servidor: %llu ticks a %d Hz en %.2f s con %zu workers, %llu atrasados\n", static_cast<unsigned long long>(tick), hz,
+               elapsedSeconds, shards.size(), static_cast<unsigned long long>(lateTicks));
+        printf("Partidas: %zu activas, %llu terminadas, %llu cerradas por sobrecarga, %llu ticks de partida salteados, %.0f ticks de partida/s\n",
+               live, static_cast<unsigned long long>(finished), static_cast<unsigned long long>(shed), static_cast<unsigned long long>(skipped),
+               elapsedSeconds > 0.0 ? matchTickCount / elapsedSeconds : 0.0);
+        printf("tick de partida  p50 %6u  p99 %6u  p99.9 %6u  max %6u ns\n", matchTicks.percentile(50), matchTicks.percentile(99),
+               matchTicks.percentile(99.9), matchTicks.max());
+        printf("tick de shard    p50 %6u  p99 %6u  p99.9 %6u  max %6u us (presupuesto %u us)\n", shardTicks.percentile(50),
+               shardTicks.percentile(99), shardTicks.percentile(99.9), shardTicks.max(), elapsedUs(0, budget));
+        printf("tick de servidor p50 %6u  p99 %6u  p99.9 %6u  max %6u us\n", serverTickUs.percentile(50), serverTickUs.percentile(99),
+               serverTickUs.percentile(99.9), serverTickUs.max());
+
+        // Las partidas con el peor tick, para ver si alguna sufre más que el resto
+        std::vector<const Match*> worst;
+        for (const auto& shard : shards) {
+            for (const Match* m : shard.matches) worst.push_back(m);
+        }
+        size_t n = worst.size() < 5 ? worst.size() : 5;
+        std::partial_sort(worst.begin(), worst.begin() + n, worst.end(),
+                          [](const Match* a, const Match* b) { return a->latency.maxNs > b->latency.maxNs; });
+        for (size_t i = 0; i < n; ++i) {
+            const Match* m = worst[i];
+            printf("  partida %08x: %llu ticks, media %.0f ns, max %u ns, %llu salteados\n", m->id,
+                   static_cast<unsigned long long>(m->ticks), m->latency.meanNs(), m->latency.maxNs,
+                   static_cast<unsigned long long>(m->skippedTicks));
+        }
+    }
+
+private:
+    // Cada worker crea sus partidas antes del primer tick
+    static void createJob(void* data, int worker) {
+        MatchServer& server = *static_cast<MatchServer*>(data);
+        Shard& shard = server.shards[worker];
+        shard.matches.reserve(shard.pendingCreate);
+        while (shard.pendingCreate > 0) {
+            Match* m = new Match();
+            m->id = shard.nextMatchId++;
+            server.levelStart.restore(m->ecs);
+            shard.matches.push_back(m);
+            --shard.pendingCreate;
+        }
+    }
+
+    static void shardJob(void* data, int worker) {
+        MatchServer& server = *static_cast<MatchServer*>(data);
+        server.runShard(server.shards[worker]);
+    }
+
+    void runShard(Shard& shard) {
+        PROFILE_ZONE("server.shard");
+        const float dT = 1.0f / hz;
+        const size_t count = shard.matches.size();
+        size_t done = 0;
+        Uint64 last = SDL_GetPerformanceCounter();
+        while (done < count) {
+            // El presupuesto se cuenta desde que arrancó el tick del servidor
+            if (last - tickStart > budget) break;
+            Match& m = *shard.matches[(shard.cursor + done) % count];
+            applyInput(m.ecs, autopilotInput(m.ecs));
+            if (update(m.ecs, dT) != GameStatus::Running) {
+                ++m.finished;
+                ++shard.finishedMatches;
+                levelStart.restore(m.ecs); // sobre su propia memoria, sin asignar
+            }
+            ++m.ticks;
+            Uint64 now = SDL_GetPerformanceCounter();
+            Uint32 ns = static_cast<Uint32>((now - last) * 1000000000ull / SDL_GetPerformanceFrequency());
+            m.latency.add(ns);
+            shard.matchTickNs.record(ns);
+            last = now;
+            ++done;
+        }
+
+        if (count) {
+            for (size_t i = done; i < count; ++i) ++shard.matches[(shard.cursor + i) % count]->skippedTicks;
+            shard.skipped += count - done;
+            shard.cursor = (shard.cursor + done) % count;
+        }
+        // Sobrecarga sostenida: cierro las partidas más nuevas, tantas como
+        // las que no entraron en este tick
+        shard.overBudgetTicks = done < count ? shard.overBudgetTicks + 1 : 0;
+        if (shard.overBudgetTicks >= SHED_AFTER_TICKS) {
+            for (size_t i = done; i < count; ++i) {
+                delete shard.matches.back();
+                shard.matches.pop_back();
+                ++shard.shed;
+            }
+            shard.overBudgetTicks = 0;
+            if (shard.cursor >= shard.matches.size()) shard.cursor = 0;
+        }
+        shard.shardTickUs.record(elapsedUs(tickStart, SDL_GetPerformanceCounter()));
+    }
+
+    WorkerPool pool;
+    std::vector<Shard> shards;
+    int hz;
+    int levelScreens;
+    WorldSnapshot levelStart;
+    Uint64 period, budget;
+    Uint64 tickStart = 0;
+    Uint64 tick;
+    Uint64 lateTicks = 0;
+    double elapsedSeconds = 0.0;
+    HdrHistogram serverTickUs;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef BREAKOUT_SPATIAL_H
+#define BREAKOUT_SPATIAL_H
+
+#include "inc/SDL.h"
+#include <algorithm>
+#include <vector>
+
+// Grilla uniforme sobre el mundo. Cada celda guarda los ids de las entidades
+// cuyo rectángulo la toca; una consulta recorre solo las celdas del área, así
+// su costo depende de lo que hay cerca y no del tamaño del nivel. Los ids que
+// caen en varias celdas se devuelven una sola vez (marca por consulta).
+class SpatialGrid {
+public:
+    SpatialGrid() : cellSize(1), columns(0), rows(0), queryStamp(0) {}
+
+    void reset(int worldWidth, int worldHeight, int cell) {
+        cellSize = cell;
+        columns = (worldWidth + cell - 1) / cell;
+        rows = (worldHeight + cell - 1) / cell;
+        cells.assign(static_cast<size_t>(columns) * rows, std::vector<int>());
+        stamps.clear();
+        queryStamp = 0;
+    }
+
+    void insert(int id, float x, float y, int w, int h) {
+        int c0, r0, c1, r1;
+        if (!cellRange(x, y, static_cast<float>(w), static_cast<float>(h), c0, r0, c1, r1)) return;
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) cells[static_cast<size_t>(r) * columns + c].push_back(id);
+        }
+        if (static_cast<size_t>(id) >= stamps.size()) stamps.resize(id + 1, 0);
+    }
+
+    // Hay que pasar el mismo rectángulo con el que se insertó
+    void remove(int id, float x, float y, int w, int h) {
+        int c0, r0, c1, r1;
+        if (!cellRange(x, y, static_cast<float>(w), static_cast<float>(h), c0, r0, c1, r1)) return;
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                std::vector<int>& cell = cells[static_cast<size_t>(r) * columns + c];
+                auto it = std::find(cell.begin(), cell.end(), id);
+                if (it != cell.end()) {
+                    *it = cell.back();
+                    cell.pop_back();
+                }
+            }
+        }
+    }
+
+    // Agrego a out los ids de las celdas que toca el área (puede haber de más,
+    // quien consulta hace la prueba exacta)
+    void query(float x, float y, float w, float h, std::vector<int>& out) {
+        int c0, r0, c1, r1;
+        if (!cellRange(x, y, w, h, c0, r0, c1, r1)) return;
+        if (++queryStamp == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            queryStamp = 1;
+        }
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                for (int id : cells[static_cast<size_t>(r) * columns + c]) {
+                    if (stamps[id] == queryStamp) continue;
+                    stamps[id] = queryStamp;
+                    out.push_back(id);
+                }
+            }
+        }
+    }
+
+    // Estado crudo, para guardar y restaurar la grilla entera (world_snapshot.h)
+    struct Layout {
+        Sint32 cellSize, columns, rows;
+        Uint32 queryStamp;
+    };
+
+    Layout layout() const { return { cellSize, columns, rows, queryStamp }; }
+    size_t cellCount() const { return cells.size(); }
+    const std::vector<int>& cell(size_t i) const { return cells[i]; }
+    const std::vector<Uint32>& queryStamps() const { return stamps; }
+
+    // Celdas aplanadas: los ids de la celda i van de ids[starts[i]] a
+    // ids[starts[i + 1]]. Las celdas que ya tienen capacidad no asignan.
+    void restore(const Layout& l, const Uint32* starts, const int* ids, const Uint32* stampData, size_t stampCount) {
+        cellSize = l.cellSize;
+        columns = l.columns;
+        rows = l.rows;
+        queryStamp = l.queryStamp;
+        cells.resize(static_cast<size_t>(columns) * rows);
+        for (size_t i = 0; i < cells.size(); ++i) cells[i].assign(ids + starts[i], ids + starts[i + 1]);
+        stamps.assign(stampData, stampData + stampCount);
+    }
+
+private:
+    bool cellRange(float x, float y, float w, float h, int& c0, int& r0, int& c1, int& r1) const {
+        if (columns == 0 || rows == 0) return false;
+        c0 = std::max(0, static_cast<int>(x) / cellSize);
+        r0 = std::max(0, static_cast<int>(y) / cellSize);
+        c1 = std::min(columns - 1, static_cast<int>(x + w) / cellSize);
+        r1 = std::min(rows - 1, static_cast<int>(y + h) / cellSize);
+        return c0 <= c1 && r0 <= r1 && x + w >= 0 && y + h >= 0;
+    }
+
+    int cellSize, columns, rows;
+    std::vector<std::vector<int>> cells;
+    std::vector<Uint32> stamps;
+    Uint32 queryStamp;
+};
+
+#endif
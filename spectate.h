@@ -0,0 +1,320 @@
+#ifndef BREAKOUT_SPECTATE_H
+#define BREAKOUT_SPECTATE_H
+
+#include "inc/SDL.h"
+#include "breakout.h"
+#include "netplay.h"
+#include "pacer.h"
+#include "state_stream.h"
+#include "telemetry.h"
+#include "world_state.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+// Transmisión para espectadores: el servidor corre el partido de verdad y en
+// cada tick manda a cada espectador, por UDP en 127.0.0.1, el mundo (las
+// palabras de packWorld()) como XOR contra el último tick que ese espectador
+// confirmó, o un keyframe si no confirmó ninguno reciente. Los espectadores
+// con la misma base comparten el paquete: se codifica una vez por base en un
+// único buffer del tick y a cada uno se le manda el mismo puntero.
+//   paquete:    magic, tick, tick base (-1: keyframe), palabras del mundo y
+//               después las palabras (keyframe) o el delta de state_stream.h
+//   confirmación: magic, tick
+const Uint32 SPECTATE_MAGIC = 0x53534B42;     // "BKSS"
+const Uint32 SPECTATE_ACK_MAGIC = 0x41534B42; // "BKSA"
+const int SPECTATE_HISTORY = 64;              // ticks que el servidor guarda como base posible
+const int SPECTATE_HEADER_BYTES = 16;
+const int MAX_DATAGRAM_BYTES = 65000;
+
+// Un espectador visto desde el servidor
+struct SpectatorSlot {
+    int port;
+    int acked = -1;      // último tick que confirmó
+    Uint64 bytes = 0;
+    Uint64 keyframes = 0;
+    Uint64 deltas = 0;
+};
+
+class SpectatorServer {
+public:
+    SpectatorServer(int spectators, int port, unsigned seed, const NetConditions& conditions)
+        : link(conditions, delayQueueCapacity(conditions, spectators)), port(port), history(SPECTATE_HISTORY), tick(0) {
+        for (int i = 0; i < spectators; ++i) {
+            SpectatorSlot slot;
+            slot.port = port + 1 + i;
+            slots.push_back(slot);
+        }
+        order.reserve(spectators);
+        tickBuffer.reserve(MAX_DATAGRAM_BYTES);
+        srand(seed);
+        initializeVersus(ecs);
+        levelStart.save(ecs);
+    }
+
+    bool open() { return link.open(port, 0); }
+
+    // Un tick: confirmaciones, simulación y envío. Devuelve los us de CPU del tick.
+    Uint32 step() {
+        Uint64 start = SDL_GetPerformanceCounter();
+        readAcks();
+
+        // El partido se juega solo y vuelve a empezar al terminar
+        applyInput(ecs, autopilotInput(ecs, 0) | autopilotInput(ecs, 1));
+        if (update(ecs, 1.0f / NETPLAY_HZ) != GameStatus::Running) levelStart.restore(ecs);
+        std::vector<Uint32>& current = history[tick % SPECTATE_HISTORY];
+        packWorld(ecs, current);
+
+        // Ordeno por base y codifico una vez por grupo
+        order.clear();
+        for (size_t i = 0; i < slots.size(); ++i) order.push_back({ baselineFor(slots[i], current), static_cast<int>(i) });
+        std::sort(order.begin(), order.end());
+        size_t i = 0;
+        while (i < order.size()) {
+            int baseline = order[i].first;
+            tickBuffer.clear();
+            appendHeader(baseline, current.size());
+            if (baseline < 0) {
+                for (Uint32 w : current) {
+                    for (int b = 0; b < 4; ++b) tickBuffer.push_back(static_cast<Uint8>(w >> (8 * b)));
+                }
+            } else {
+                encodeStateDelta(current, history[baseline % SPECTATE_HISTORY], tickBuffer);
+            }
+            ++encodes;
+            if (tickBuffer.size() > MAX_DATAGRAM_BYTES) {
+                ++oversized; // no entra en un datagrama: este tick no se manda a este grupo
+                while (i < order.size() && order[i].first == baseline) ++i;
+                continue;
+            }
+            // Mismo buffer para todos los del grupo
+            for (; i < order.size() && order[i].first == baseline; ++i) {
+                SpectatorSlot& slot = slots[order[i].second];
+                link.sendTo(slot.port, tickBuffer.data(), static_cast<int>(tickBuffer.size()));
+                slot.bytes += tickBuffer.size();
+                if (baseline < 0) ++slot.keyframes;
+                else ++slot.deltas;
+            }
+        }
+        link.flush();
+        ++tick;
+        Uint32 us = elapsedUs(start, SDL_GetPerformanceCounter());
+        tickUs.record(us);
+        return us;
+    }
+
+    // Corro a NETPLAY_HZ durante seconds segundos
+    void run(double seconds) {
+        const Uint64 freq = SDL_GetPerformanceFrequency();
+        const Uint64 step = freq / NETPLAY_HZ;
+        const Uint64 margin = calibrateSleepOvershoot();
+        const Uint64 start = SDL_GetPerformanceCounter();
+        const Uint64 end = start + static_cast<Uint64>(seconds * freq);
+        Uint64 next = start;
+        while (SDL_GetPerformanceCounter() < end) {
+            this->step();
+            next += step;
+            Uint64 now = SDL_GetPerformanceCounter();
+            if (now < next) sleepUntil(next, margin);
+            else next = now;
+        }
+        elapsedSeconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(freq);
+    }
+
+    // Estado que mandé en un tick, si todavía lo tengo
+    const std::vector<Uint32>* stateAt(int t) const {
+        if (t < 0 || t >= tick || tick - t > SPECTATE_HISTORY) return nullptr;
+        return &history[t % SPECTATE_HISTORY];
+    }
+
+    void printReport() const {
+        Uint64 bytes = 0, keyframes = 0, deltas = 0;
+        for (const auto& s : slots) {
+            bytes += s.bytes;
+            keyframes += s.keyframes;
+            deltas += s.deltas;
+        }
+        const double perSpectator = slots.empty() || elapsedSeconds <= 0.0 ? 0.0 : bytes / elapsedSeconds / slots.size();
+        printf("Espectadores: %zu, %d ticks a %d Hz en %.2f s\n", slots.size(), tick, NETPLAY_HZ, elapsedSeconds);
+        printf("Ancho de banda: %.1f KB/s por espectador (%.1f bytes por paquete), %llu keyframes y %llu deltas, %llu paquetes perdidos por el simulador"
+               " y %llu con la cola de demora llena\n",
+               perSpectator / 1024.0, keyframes + deltas ? static_cast<double>(bytes) / (keyframes + deltas) : 0.0,
+               static_cast<unsigned long long>(keyframes), static_cast<unsigned long long>(deltas),
+               static_cast<unsigned long long>(link.dropped), static_cast<unsigned long long>(link.overflowed));
+        printf("CPU del servidor: p50 %u  p99 %u  max %u us por tick (%.2f us por espectador), %.2f codificaciones por tick",
+               tickUs.percentile(50), tickUs.percentile(99), tickUs.max(), slots.empty() ? 0.0 : tickUs.mean() / slots.size(),
+               tick ? static_cast<double>(encodes) / tick : 0.0);
+        if (oversized) printf(", %llu paquetes no entraron en un datagrama", static_cast<unsigned long long>(oversized));
+        printf("\n");
+    }
+
+private:
+    // Base para el espectador: lo último que confirmó, si sigue en la historia y es del mismo tamaño
+    int baselineFor(const SpectatorSlot& slot, const std::vector<Uint32>& current) const {
+        if (slot.acked < 0 || tick - slot.acked >= SPECTATE_HISTORY) return -1;
+        return history[slot.acked % SPECTATE_HISTORY].size() == current.size() ? slot.acked : -1;
+    }
+
+    void appendHeader(int baseline, size_t words) {
+        tickBuffer.resize(SPECTATE_HEADER_BYTES);
+        putLE32(tickBuffer.data(), static_cast<Sint32>(SPECTATE_MAGIC));
+        putLE32(tickBuffer.data() + 4, tick);
+        putLE32(tickBuffer.data() + 8, baseline);
+        putLE32(tickBuffer.data() + 12, static_cast<Sint32>(words));
+    }
+
+    void readAcks() {
+        Uint8 packet[8];
+        int from, n;
+        while ((n = link.receive(packet, sizeof(packet), &from)) >= 0) {
+            if (n != 8 || static_cast<Uint32>(getLE32(packet)) != SPECTATE_ACK_MAGIC) continue;
+            int index = from - port - 1;
+            if (index < 0 || index >= static_cast<int>(slots.size())) continue;
+            int acked = getLE32(packet + 4);
+            if (acked > slots[index].acked && acked < tick) slots[index].acked = acked;
+        }
+    }
+
+    ECS ecs;
+    WorldSnapshot levelStart;
+    NetLink link;
+    int port;
+    std::vector<SpectatorSlot> slots;
+    std::vector<std::pair<int, int>> order;  // (base, espectador)
+    std::vector<std::vector<Uint32>> history; // mundo de cada uno de los últimos ticks
+    std::vector<Uint8> tickBuffer;            // el paquete que se está mandando, uno por tick y base
+    int tick;
+    Uint64 encodes = 0, oversized = 0;
+    double elapsedSeconds = 0.0;
+    HdrHistogram tickUs;
+};
+
+// Un espectador: arma el mundo con lo que recibe y confirma cada tick
+class SpectatorClient {
+public:
+    SpectatorClient(int port, int serverPort, const NetConditions& conditions)
+        : link(conditions), port(port), serverPort(serverPort), states(SPECTATE_HISTORY), ticks(SPECTATE_HISTORY, -1),
+          packet(MAX_DATAGRAM_BYTES) {}
+
+    bool open() { return link.open(port, serverPort); }
+
+    // Proceso lo que llegó; devuelve cuántos paquetes
+    int poll() {
+        int count = 0, n;
+        while ((n = link.receive(packet.data(), static_cast<int>(packet.size()))) >= 0) {
+            if (n < SPECTATE_HEADER_BYTES) continue; // corto: sigo con los de atrás
+            ++count;
+            bytes += n;
+            apply(n);
+        }
+        link.flush();
+        return count;
+    }
+
+    int getLatest() const { return latest; }
+    const std::vector<Uint32>* stateAt(int t) const {
+        return t >= 0 && ticks[t % SPECTATE_HISTORY] == t ? &states[t % SPECTATE_HISTORY] : nullptr;
+    }
+
+    Uint64 bytes = 0;
+    Uint64 missingBaseline = 0; // deltas contra una base que ya no tengo
+
+private:
+    void apply(int n) {
+        if (static_cast<Uint32>(getLE32(packet.data())) != SPECTATE_MAGIC) return;
+        int tick = getLE32(packet.data() + 4);
+        int baseline = getLE32(packet.data() + 8);
+        size_t words = static_cast<size_t>(getLE32(packet.data() + 12));
+        if (tick <= latest) return; // viejo o repetido
+        const Uint8* payload = packet.data() + SPECTATE_HEADER_BYTES;
+        std::vector<Uint32>& state = states[tick % SPECTATE_HISTORY];
+        if (baseline < 0) {
+            if (static_cast<size_t>(n - SPECTATE_HEADER_BYTES) != words * 4) return;
+            state.resize(words);
+            for (size_t i = 0; i < words; ++i) {
+                state[i] = static_cast<Uint32>(payload[4 * i]) | static_cast<Uint32>(payload[4 * i + 1]) << 8 |
+                           static_cast<Uint32>(payload[4 * i + 2]) << 16 | static_cast<Uint32>(payload[4 * i + 3]) << 24;
+            }
+        } else {
+            const std::vector<Uint32>* base = stateAt(baseline);
+            if (!base || base->size() != words) {
+                ++missingBaseline;
+                return;
+            }
+            state = *base; // misma cantidad de palabras: no asigna
+            if (!applyStateDelta(payload, packet.data() + n, state)) return;
+        }
+        ticks[tick % SPECTATE_HISTORY] = tick;
+        latest = tick;
+
+        Uint8 ack[8];
+        putLE32(ack, static_cast<Sint32>(SPECTATE_ACK_MAGIC));
+        putLE32(ack + 4, tick);
+        link.send(ack, sizeof(ack));
+    }
+
+    NetLink link;
+    int port, serverPort;
+    std::vector<std::vector<Uint32>> states; // mundos recibidos, por tick
+    std::vector<int> ticks;                  // tick de cada lugar de states
+    std::vector<Uint8> packet;
+    int latest = -1;
+};
+
+// Los espectadores corren en su propio hilo, como si fueran otros procesos
+struct SpectatorThread {
+    std::vector<SpectatorClient*> clients;
+    SDL_atomic_t quit;
+};
+
+inline int SDLCALL spectatorMain(void* data) {
+    SpectatorThread& t = *static_cast<SpectatorThread*>(data);
+    while (!SDL_AtomicGet(&t.quit)) {
+        int received = 0;
+        for (SpectatorClient* c : t.clients) received += c->poll();
+        if (received == 0) SDL_Delay(1);
+    }
+    return 0;
+}
+
+// Servidor y espectadores en 127.0.0.1 durante seconds segundos; verifico al
+// final que cada espectador tenga el mismo mundo que el servidor
+inline int runSpectators(int spectators, double seconds, int port, unsigned seed, const NetConditions& conditions) {
+    SpectatorServer server(spectators, port, seed, conditions);
+    if (!server.open()) {
+        printf("No pude abrir el puerto UDP %d\n", port);
+        return 1;
+    }
+    SpectatorThread thread;
+    SDL_AtomicSet(&thread.quit, 0);
+    for (int i = 0; i < spectators; ++i) {
+        SpectatorClient* c = new SpectatorClient(port + 1 + i, port, conditions);
+        if (!c->open()) {
+            printf("No pude abrir el puerto UDP %d\n", port + 1 + i);
+            delete c;
+            break;
+        }
+        thread.clients.push_back(c);
+    }
+    SDL_Thread* handle = SDL_CreateThread(spectatorMain, "spectators", &thread);
+    server.run(seconds);
+    SDL_Delay(200 + 2 * conditions.latencyMs + conditions.jitterMs); // que lleguen los últimos paquetes
+    SDL_AtomicSet(&thread.quit, 1);
+    SDL_WaitThread(handle, NULL);
+
+    server.printReport();
+    int synced = 0;
+    Uint64 missing = 0;
+    for (SpectatorClient* c : thread.clients) {
+        const std::vector<Uint32>* mine = c->stateAt(c->getLatest());
+        const std::vector<Uint32>* truth = server.stateAt(c->getLatest());
+        if (mine && truth && *mine == *truth) ++synced;
+        missing += c->missingBaseline;
+        delete c;
+    }
+    printf("%d de %d espectadores con el mismo mundo que el servidor, %llu deltas sin base\n", synced, spectators,
+           static_cast<unsigned long long>(missing));
+    return synced == spectators ? 0 : 1;
+}
+
+#endif
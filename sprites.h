@@ -0,0 +1,86 @@
+#ifndef BREAKOUT_SPRITES_H
+#define BREAKOUT_SPRITES_H
+
+#include "inc/SDL.h"
+#include "atlas.h"
+#include <string>
+
+// Ids de sprite en el atlas, en el orden en que los agrega loadSprites()
+enum SpriteId { SPRITE_SOLID = 0, SPRITE_PADDLE = 1, SPRITE_BALL = 2, SPRITE_BLOCK = 3 };
+
+inline void putPixel(SDL_Surface* s, int x, int y, Uint8 gray, Uint8 alpha) {
+    static_cast<Uint32*>(s->pixels)[y * (s->pitch / 4) + x] =
+        (static_cast<Uint32>(alpha) << 24) | (static_cast<Uint32>(gray) << 16) | (static_cast<Uint32>(gray) << 8) | gray;
+}
+
+// Las imágenes son en escala de grises: el color de cada entidad llega como
+// modulación de vértice, así un mismo sprite sirve para todos los bloques
+
+// Bloque con bisel: borde claro arriba/izquierda y oscuro abajo/derecha
+inline SDL_Surface* makeBlockSprite(int w, int h) {
+    SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            Uint8 gray = 210;
+            if (x < 2 || y < 2) gray = 255;
+            else if (x >= w - 2 || y >= h - 2) gray = 140;
+            putPixel(s, x, y, gray, 0xFF);
+        }
+    }
+    return s;
+}
+
+// Pelota redonda con un brillo arriba a la izquierda
+inline SDL_Surface* makeBallSprite(int size) {
+    SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+    const float r = size / 2.0f;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            float dx = x + 0.5f - r, dy = y + 0.5f - r;
+            float d2 = dx * dx + dy * dy;
+            if (d2 > r * r) {
+                putPixel(s, x, y, 0, 0);
+                continue;
+            }
+            float hx = dx + r / 3.0f, hy = dy + r / 3.0f;
+            float highlight = 1.0f - (hx * hx + hy * hy) / (r * r * 2.0f);
+            putPixel(s, x, y, static_cast<Uint8>(160 + 95 * (highlight > 0 ? highlight : 0)), 0xFF);
+        }
+    }
+    return s;
+}
+
+// Paddle con puntas redondeadas y degradé vertical
+inline SDL_Surface* makePaddleSprite(int w, int h) {
+    SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    const float r = h / 2.0f;
+    for (int y = 0; y < h; ++y) {
+        Uint8 gray = static_cast<Uint8>(255 - 90 * y / h);
+        for (int x = 0; x < w; ++x) {
+            float cx = x < r ? r : (x >= w - r ? w - r : x + 0.5f);
+            float dx = x + 0.5f - cx, dy = y + 0.5f - r;
+            bool inside = dx * dx + dy * dy <= r * r;
+            putPixel(s, x, y, gray, inside ? 0xFF : 0);
+        }
+    }
+    return s;
+}
+
+// Si existe assets/NAME.bmp lo uso en lugar de la imagen generada
+inline SDL_Surface* loadSpriteOr(const char* name, SDL_Surface* generated) {
+    SDL_Surface* loaded = SDL_LoadBMP((std::string("assets/") + name + ".bmp").c_str());
+    if (!loaded) return generated;
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    if (!converted) return generated;
+    SDL_FreeSurface(generated);
+    return converted;
+}
+
+inline void loadSprites(TextureAtlas& atlas, int paddleW, int paddleH, int ballSize, int blockW, int blockH) {
+    atlas.add("paddle", loadSpriteOr("paddle", makePaddleSprite(paddleW, paddleH)));
+    atlas.add("ball", loadSpriteOr("ball", makeBallSprite(ballSize)));
+    atlas.add("block", loadSpriteOr("block", makeBlockSprite(blockW, blockH)));
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef BREAKOUT_STATE_HASH_H
+#define BREAKOUT_STATE_HASH_H
+
+#include "inc/SDL.h"
+#include "inc/SDL_test_crc32.h"
+#include "state_stream.h"
+#include "world_state.h"
+#include <cstdio>
+#include <vector>
+
+// Hash del mundo por tick para saber dónde se separan dos simulaciones: CRC32
+// sobre las palabras de packWorld(), que no tienen relleno y salen iguales en
+// cualquier máquina little endian. El versus son unas 500 palabras (2 KB) y
+// unos 9 us por hash, porque el CRC32 va byte por byte. Las grabaciones y el netplay
+// guardan un hash por tick; para saber qué entidad y qué campo difieren hacen
+// falta los estados completos (archivos de --state-stream) y firstStateDifference().
+class WorldHasher {
+public:
+    WorldHasher() { SDLTest_Crc32Init(&crcContext); }
+    ~WorldHasher() { SDLTest_Crc32Done(&crcContext); }
+
+    WorldHasher(const WorldHasher&) = delete;
+    WorldHasher& operator=(const WorldHasher&) = delete;
+
+    Uint32 hash(const ECS& ecs) {
+        packWorld(ecs, words);
+        return hash(words);
+    }
+
+    Uint32 hash(const std::vector<Uint32>& state) {
+        CrcUint32 crc = 0;
+        SDLTest_Crc32Calc(&crcContext, reinterpret_cast<CrcUint8*>(const_cast<Uint32*>(state.data())),
+                          static_cast<CrcUint32>(state.size() * sizeof(Uint32)), &crc);
+        return crc;
+    }
+
+private:
+    SDLTest_Crc32Context crcContext;
+    std::vector<Uint32> words;
+};
+
+// A qué corresponde una palabra de packWorld()
+struct WordLocation {
+    const char* component; // "mundo" para los contadores del principio
+    int entity;            // -1 si es un contador
+    const char* field;
+    char type;             // como en PackedComponent
+};
+
+inline bool locateWord(const std::vector<Uint32>& words, size_t index, WordLocation& out) {
+    if (index < static_cast<size_t>(WORLD_HEADER_WORDS)) {
+        out = { "mundo", -1, WORLD_HEADER_FIELDS[index], 'i' };
+        return true;
+    }
+    size_t p = WORLD_HEADER_WORDS;
+    for (const PackedComponent& c : WORLD_STATE_COMPONENTS) {
+        if (p >= words.size()) return false;
+        if (index == p) {
+            out = { c.name, -1, "cantidad", 'i' };
+            return true;
+        }
+        const size_t stride = 1 + c.fields;
+        const size_t items = words[p++];
+        if (index < p + items * stride) {
+            size_t item = p + (index - p) / stride * stride;
+            size_t k = index - item;
+            out = { c.name, static_cast<int>(words[item]), k == 0 ? "id" : c.fieldNames[k - 1], k == 0 ? 'i' : c.types[k - 1] };
+            return true;
+        }
+        p += items * stride;
+    }
+    return false;
+}
+
+inline void printWordValue(char type, Uint32 v) {
+    if (type == 'f') printf("%.6g", bitsFloat(v));
+    else if (type == 'c') printf("#%08x", v);
+    else printf("%d", static_cast<int>(v));
+}
+
+// Muestro las primeras palabras distintas entre dos estados. Si difiere una
+// cantidad, lo que sigue ya no se corresponde y corto ahí.
+inline int printStateDifference(const std::vector<Uint32>& a, const std::vector<Uint32>& b, int limit = 8) {
+    int shown = 0;
+    const size_t count = a.size() < b.size() ? a.size() : b.size();
+    for (size_t i = 0; i < count && shown < limit; ++i) {
+        if (a[i] == b[i]) continue;
+        WordLocation where;
+        if (!locateWord(a, i, where)) break;
+        if (where.entity >= 0) printf("  %s de la entidad %d, %s: ", where.component, where.entity, where.field);
+        else printf("  %s, %s: ", where.component, where.field);
+        printWordValue(where.type, a[i]);
+        printf(" contra ");
+        printWordValue(where.type, b[i]);
+        printf("\n");
+        ++shown;
+        if (where.entity < 0 && i >= static_cast<size_t>(WORLD_HEADER_WORDS)) {
+            printf("  (cambia la cantidad de elementos, no sigo comparando)\n");
+            break;
+        }
+    }
+    if (shown == 0 && a.size() != b.size()) {
+        printf("  uno tiene %zu palabras y el otro %zu\n", a.size(), b.size());
+        ++shown;
+    }
+    return shown;
+}
+
+// Primer tick en que difieren dos archivos de estados. Se leen los dos en
+// orden y se comparan todos los ticks: dos simulaciones pueden separarse
+// unos ticks y volver a coincidir (un paddle corrido que empuja la pelota
+// distinto hasta que choca contra la pared), así que no alcanza con mirar
+// algunos. Leer en orden solo aplica deltas, unos pocos bytes por tick.
+// Devuelve el tick, con los estados de ese tick en wordsA y wordsB; -1 si
+// coinciden en todos los ticks que tienen los dos y -2 si no se pudo leer.
+inline long long firstStateDifference(StateStreamReader& a, StateStreamReader& b, std::vector<Uint32>& wordsA,
+                                      std::vector<Uint32>& wordsB) {
+    const Uint64 common = a.getTicks() < b.getTicks() ? a.getTicks() : b.getTicks();
+    a.rewind();
+    b.rewind();
+    for (Uint64 tick = 0; tick < common; ++tick) {
+        if (!a.next(wordsA) || !b.next(wordsB)) return -2;
+        if (wordsA != wordsB) return static_cast<long long>(tick);
+    }
+    return -1;
+}
+
+#endif
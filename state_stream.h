@@ -0,0 +1,337 @@
+#ifndef BREAKOUT_STATE_STREAM_H
+#define BREAKOUT_STATE_STREAM_H
+
+#include "inc/SDL.h"
+#include "varint.h"
+#include "world_state.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN // que windows.h no traiga winsock.h y no choque con netplay.h
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX // sin las macros min y max, que rompen std::min y los .max() de los histogramas
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Archivo de estados por tick: cabecera "BKSTM1" + intervalo entre
+// keyframes, un registro por tick y un índice al final.
+//   registro: varint (bytes << 1 | keyframe) y después
+//     keyframe: las palabras de packWorld() tal cual (little endian)
+//     delta:    XOR contra las palabras del tick anterior, como tramos de
+//               varint (palabras iguales, palabras distintas) seguidos de
+//               los XOR de las distintas en varint
+//   índice:   (tick, offset) de cada keyframe en Uint64, y al final
+//             cantidad de keyframes, ticks, offset del índice y "BKSTMIDX"
+// Para ir a un tick se busca el keyframe anterior en el índice y se aplican
+// los deltas que siguen, leyendo directo del archivo mapeado en memoria.
+const char STATE_STREAM_MAGIC[8] = { 'B', 'K', 'S', 'T', 'M', '1', 0, 0 };
+const char STATE_INDEX_MAGIC[8] = { 'B', 'K', 'S', 'T', 'M', 'I', 'D', 'X' };
+const size_t STATE_HEADER_BYTES = 16;
+const size_t STATE_FOOTER_BYTES = 32;
+
+// XOR de current contra previous (misma cantidad de palabras)
+inline void encodeStateDelta(const std::vector<Uint32>& current, const std::vector<Uint32>& previous, std::vector<Uint8>& out) {
+    size_t i = 0;
+    const size_t count = current.size();
+    while (i < count) {
+        size_t same = i;
+        while (same < count && current[same] == previous[same]) ++same;
+        if (same == count) break; // lo que falta es igual: no hace falta escribirlo
+        size_t changed = same;
+        while (changed < count && current[changed] != previous[changed]) ++changed;
+        appendVarint(out, same - i);
+        appendVarint(out, changed - same);
+        for (size_t k = same; k < changed; ++k) appendVarint(out, current[k] ^ previous[k]);
+        i = changed;
+    }
+}
+
+inline bool applyStateDelta(const Uint8* in, const Uint8* end, std::vector<Uint32>& words) {
+    size_t i = 0;
+    while (in < end) {
+        Uint64 same, changed, x;
+        if (!readVarint(in, end, same) || !readVarint(in, end, changed)) return false;
+        i += same;
+        if (i + changed > words.size()) return false;
+        for (Uint64 k = 0; k < changed; ++k) {
+            if (!readVarint(in, end, x)) return false;
+            words[i++] ^= static_cast<Uint32>(x);
+        }
+    }
+    return true;
+}
+
+// Escribe un estado por tick con SDL_RWops de a bloques
+class StateStreamWriter {
+public:
+    StateStreamWriter(const char* path, int keyframeInterval)
+        : interval(keyframeInterval > 0 ? keyframeInterval : 600), ticks(0), offset(STATE_HEADER_BYTES), keyframeBytes(0), deltaBytes(0) {
+        buffer.reserve(2 * FLUSH_BYTES);
+        file = SDL_RWFromFile(path, "wb");
+        if (!file) return;
+        SDL_RWwrite(file, STATE_STREAM_MAGIC, 1, sizeof(STATE_STREAM_MAGIC));
+        SDL_WriteLE32(file, static_cast<Uint32>(interval));
+        SDL_WriteLE32(file, 0);
+    }
+
+    ~StateStreamWriter() { finish(); }
+
+    StateStreamWriter(const StateStreamWriter&) = delete;
+    StateStreamWriter& operator=(const StateStreamWriter&) = delete;
+
+    bool ok() const { return file != nullptr; }
+
+    // Estado del mundo después del tick
+    void writeTick(const ECS& ecs) {
+        if (!file) return;
+        packWorld(ecs, current);
+        // Keyframe cada interval ticks o si cambió la cantidad de entidades
+        bool keyframe = ticks % interval == 0 || current.size() != previous.size();
+        payload.clear();
+        if (keyframe) {
+            index.push_back(ticks);
+            index.push_back(offset);
+            for (Uint32 w : current) {
+                for (int b = 0; b < 4; ++b) payload.push_back(static_cast<Uint8>(w >> (8 * b)));
+            }
+            keyframeBytes += payload.size();
+        } else {
+            encodeStateDelta(current, previous, payload);
+            deltaBytes += payload.size();
+        }
+        size_t before = buffer.size();
+        appendVarint(buffer, static_cast<Uint64>(payload.size()) << 1 | (keyframe ? 1 : 0));
+        buffer.insert(buffer.end(), payload.begin(), payload.end());
+        offset += buffer.size() - before;
+        if (buffer.size() >= FLUSH_BYTES) writeBuffer();
+        current.swap(previous);
+        ++ticks;
+    }
+
+    void finish() {
+        if (!file) return;
+        writeBuffer();
+        Uint64 indexOffset = offset;
+        for (Uint64 v : index) SDL_WriteLE64(file, v);
+        SDL_WriteLE64(file, index.size() / 2);
+        SDL_WriteLE64(file, ticks);
+        SDL_WriteLE64(file, indexOffset);
+        SDL_RWwrite(file, STATE_INDEX_MAGIC, 1, sizeof(STATE_INDEX_MAGIC));
+        SDL_RWclose(file);
+        file = nullptr;
+        Uint64 total = indexOffset + index.size() * 8 + STATE_FOOTER_BYTES;
+        printf("Estados: %llu ticks, %zu keyframes, %llu bytes (%.1f bytes por tick; deltas %.1f bytes por tick)\n",
+               static_cast<unsigned long long>(ticks), index.size() / 2, static_cast<unsigned long long>(total),
+               ticks ? static_cast<double>(total) / ticks : 0.0,
+               ticks > index.size() / 2 ? static_cast<double>(deltaBytes) / (ticks - index.size() / 2) : 0.0);
+    }
+
+private:
+    static const size_t FLUSH_BYTES = 64 * 1024;
+
+    void writeBuffer() {
+        if (!buffer.empty()) SDL_RWwrite(file, buffer.data(), 1, buffer.size());
+        buffer.clear();
+    }
+
+    SDL_RWops* file;
+    int interval;
+    Uint64 ticks, offset;
+    Uint64 keyframeBytes, deltaBytes;
+    std::vector<Uint32> current, previous;
+    std::vector<Uint8> payload, buffer;
+    std::vector<Uint64> index; // tick, offset por keyframe
+};
+
+// Archivo de solo lectura mapeado en memoria
+class MappedFile {
+public:
+    MappedFile() : base(nullptr), length(0) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path) {
+        close();
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (!mapping) return false;
+        base = static_cast<const Uint8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if (!base) return false;
+        length = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base = static_cast<const Uint8*>(p);
+        length = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+        if (!base) return;
+#if defined(_WIN32)
+        UnmapViewOfFile(base);
+#else
+        munmap(const_cast<Uint8*>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    const Uint8* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const Uint8* base;
+    size_t length;
+};
+
+inline Uint64 loadLE64(const Uint8* p) {
+    Uint64 v = 0;
+    for (int b = 7; b >= 0; --b) v = v << 8 | p[b];
+    return v;
+}
+
+// Acceso aleatorio a un archivo de estados
+class StateStreamReader {
+public:
+    bool open(const char* path) {
+        if (!file.open(path)) return false;
+        const Uint8* data = file.data();
+        size_t size = file.size();
+        if (size < STATE_HEADER_BYTES + STATE_FOOTER_BYTES || memcmp(data, STATE_STREAM_MAGIC, sizeof(STATE_STREAM_MAGIC)) != 0 ||
+            memcmp(data + size - sizeof(STATE_INDEX_MAGIC), STATE_INDEX_MAGIC, sizeof(STATE_INDEX_MAGIC)) != 0) {
+            file.close();
+            return false;
+        }
+        const Uint8* footer = data + size - STATE_FOOTER_BYTES;
+        keyframes = loadLE64(footer);
+        ticks = loadLE64(footer + 8);
+        indexOffset = loadLE64(footer + 16);
+        // El índice ocupa exactamente lo que hay entre los registros y el pie;
+        // no le sumo nada a indexOffset, que viene del archivo y podría dar la vuelta
+        if (keyframes > (size - STATE_HEADER_BYTES - STATE_FOOTER_BYTES) / 16 ||
+            indexOffset != size - STATE_FOOTER_BYTES - keyframes * 16 || (keyframes == 0) != (ticks == 0)) {
+            file.close();
+            return false;
+        }
+        index = data + indexOffset;
+        // Cada keyframe tiene que caer entre la cabecera y el índice, en orden,
+        // el primero en el tick 0 justo después de la cabecera (de ahí lee
+        // rewind()) y todos antes del último tick, y empezar con
+        // un registro marcado como keyframe; así seek() no lee fuera del archivo
+        // ni aplica un delta sobre lo que haya quedado en words
+        for (Uint64 k = 0; k < keyframes; ++k) {
+            Uint64 tick = loadLE64(index + k * 16);
+            Uint64 offset = loadLE64(index + k * 16 + 8);
+            bool ordered = k == 0 || (tick > loadLE64(index + (k - 1) * 16) && offset > loadLE64(index + (k - 1) * 16 + 8));
+            if (tick >= ticks || (k == 0 && (tick != 0 || offset != STATE_HEADER_BYTES)) || offset < STATE_HEADER_BYTES || offset >= indexOffset || !ordered) {
+                file.close();
+                return false;
+            }
+            const Uint8* p = data + offset;
+            Uint64 code;
+            if (!readVarint(p, data + indexOffset, code) || !(code & 1)) {
+                file.close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Uint64 getTicks() const { return ticks; }
+    Uint64 getKeyframes() const { return keyframes; }
+
+    // Palabras del estado después del tick (cuenta desde 0)
+    bool seek(Uint64 tick, std::vector<Uint32>& words) {
+        if (tick >= ticks || keyframes == 0) return false;
+        // Último keyframe con tick <= el pedido
+        Uint64 lo = 0, hi = keyframes;
+        while (hi - lo > 1) {
+            Uint64 mid = (lo + hi) / 2;
+            if (loadLE64(index + mid * 16) <= tick) lo = mid;
+            else hi = mid;
+        }
+        Uint64 t = loadLE64(index + lo * 16);
+        const Uint8* p = file.data() + loadLE64(index + lo * 16 + 8);
+        for (;;) {
+            if (!readRecord(p, words)) return false;
+            if (t == tick) return true;
+            ++t;
+        }
+    }
+
+    // Lectura en orden desde el tick 0, sin saltar: cada next() deja en
+    // words el tick siguiente aplicando solo su delta
+    void rewind() {
+        cursor = file.data() + STATE_HEADER_BYTES;
+        cursorTick = 0;
+    }
+
+    bool next(std::vector<Uint32>& words) {
+        if (!cursor || cursorTick >= ticks || !readRecord(cursor, words)) return false;
+        ++cursorTick;
+        return true;
+    }
+
+    bool seek(Uint64 tick, ECS& ecs) {
+        return seek(tick, scratch) && unpackWorld(scratch.data(), scratch.size(), ecs);
+    }
+
+private:
+    // Un registro (keyframe o delta sobre words) desde p; avanza p
+    bool readRecord(const Uint8*& p, std::vector<Uint32>& words) const {
+        const Uint8* end = file.data() + indexOffset;
+        Uint64 code;
+        if (!readVarint(p, end, code)) return false;
+        size_t bytes = static_cast<size_t>(code >> 1);
+        if (bytes > static_cast<size_t>(end - p)) return false;
+        if (code & 1) {
+            // Un keyframe son palabras enteras y nunca está vacío (la cabecera de packWorld)
+            if (bytes == 0 || bytes % 4 != 0) return false;
+            words.resize(bytes / 4);
+            memcpy(words.data(), p, bytes); // little endian, como se escribió
+        } else if (!applyStateDelta(p, p + bytes, words)) {
+            return false;
+        }
+        p += bytes;
+        return true;
+    }
+
+    MappedFile file;
+    Uint64 keyframes = 0, ticks = 0, indexOffset = 0;
+    const Uint8* index = nullptr;
+    const Uint8* cursor = nullptr;
+    Uint64 cursorTick = 0;
+    std::vector<Uint32> scratch;
+};
+
+#endif
@@ -1,270 +1,1019 @@
 #define SDL_MAIN_HANDLED
+#define BREAKOUT_ALLOCATION_HOOKS // este archivo define el new/delete que cuenta asignaciones
 #include "inc/SDL.h"
+#include "allocation.h"
+#include "breakout.h"
+#include "capture.h"
+#include "golden.h"
+#include "headless.h"
+#include "netplay.h"
+#include "pacer.h"
+#include "replay.h"
+#include "server.h"
+#include "spectate.h"
+#include "telemetry.h"
+#include "vec_env.h"
 #include <iostream>
 #include <vector>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <unordered_map>
-
-
-const int SCREEN_WIDTH = 750;
-const int SCREEN_HEIGHT = 480;
-const int MAX_FPS = 60;
-const int BALL_SPEED = 200;
-const int BALL_SIZE = 20;
-const int PADDLE_WIDTH = 100;
-const int PADDLE_HEIGHT = 20;
-const int BLOCK_WIDTH = 60;
-const int BLOCK_HEIGHT = 20;
-const int BLOCK_ROWS = 5;
-const int BLOCK_COLUMNS = 10;
-const int PADDLE_SPEED = 300;
-
-// Estructuro los componentes
-struct Position {
-    float x, y;
-};
 
-struct Velocity {
-    float vx, vy;
-};
 
-struct Color {
-    SDL_Color color;
-};
-
-struct Paddle {};
-struct Ball {};
-struct Block { bool active; };
+// Copio el frame dibujado a la captura, antes de presentarlo
+void captureFrame(FrameCapture& capture, RenderContext& ctx) {
+    if (ctx.tiles) {
+        capture.capture(ctx.tiles->pixels());
+    } else {
+        capture.capture(ctx.renderer);
+    }
+}
 
-// Clase para entidades
-class Entity {
-public:
-    int id;
-    Entity(int id) : id(id) {}
+// Opciones de línea de comandos
+struct Options {
+    bool software = false;  // --software: rasterizo por tiles en CPU
+    int threads = 0;        // --threads N: workers para grabar comandos y rasterizar (0 = núcleos disponibles)
+    bool benchTiles = false; // --bench-tiles: benchmark del rasterizador y salgo
+    bool threaded = false;  // --threaded: simulación en su propio hilo
+    int simHz = 120;        // --sim-hz N: ticks por segundo de la simulación en modo --threaded y --headless
+    const char* goldenRecord = nullptr; // --golden-record LOG: escribo el hash de cada frame
+    const char* goldenCheck = nullptr;  // --golden-check LOG: comparo cada frame contra el log
+    const char* goldenImages = nullptr; // --golden-images DIR: imágenes de referencia y frames distintos
+    int frames = 3000;                  // --frames N: frames de la corrida golden
+    unsigned seed = 1;                  // --seed N: semilla de rand() para los colores
+    const char* capturePath = nullptr;  // --capture FILE: grabo la sesión en segundo plano
+    const char* exportCapture = nullptr; // --capture-export FILE DIR: paso una captura a BMPs
+    const char* exportDir = nullptr;
+    bool flat = false;                  // --flat: rectángulos sólidos en lugar de sprites
+    bool hud = true;                    // --no-hud: sin overlay de FPS y estadísticas
+    bool particles = true;              // --no-particles: sin efectos al romper bloques
+    int benchParticles = 0;             // --bench-particles N: benchmark con N partículas vivas y salgo
+    int levelScreens = 1;               // --level-screens N: nivel de N pantallas de alto con cámara
+    PaceMode pace = PACE_FIXED;         // --pace fixed|vsync|uncapped|legacy: cómo se limitan los frames
+    int fps = MAX_FPS;                  // --fps N: frames por segundo en modo fixed
+    const char* telemetryPrefix = nullptr; // --telemetry PREFIX: exporto PREFIX.csv y PREFIX.json al salir
+    const char* tracePath = nullptr;    // --trace FILE: traza Chrome de los frames alrededor del primer hitch
+    int traceFrames = 120;              // --trace-frames N: frames en la traza
+    bool trackAllocations = false;      // --track-allocs: asignaciones por frame y por zona
+    bool allocStrict = false;           // --alloc-strict: falla si un frame asigna después del calentamiento
+    int allocWarmup = 120;              // --alloc-warmup N: frames de calentamiento
+    bool perf = false;                  // --perf: contadores de hardware por zona (solo Linux)
+    long long headlessTicks = 0;        // --headless N: simulo N ticks sin ventana ni límite y salgo
+    const char* scriptPath = nullptr;   // --script FILE: entrada guionada en lugar del piloto automático
+    int headlessWorlds = 1;             // --headless-worlds N: mundos independientes, uno por hilo
+    int serverMatches = 0;              // --server N: N partidas sin ventana repartidas en --threads workers
+    double serverSeconds = 10.0;        // --server-seconds S: cuánto corre el servidor
+    int serverHz = MAX_FPS;             // --server-hz N: ticks por segundo de cada partida
+    const char* recordPath = nullptr;   // --record FILE: grabo entrada y dT de cada tick
+    const char* replayPath = nullptr;   // --replay FILE: reproduzco una grabación en la ventana
+    const char* replayHeadlessPath = nullptr; // --replay-headless FILE: reproduzco sin ventana ni esperas
+    const char* statePath = nullptr;    // --state-stream FILE: guardo el estado de cada tick (con --replay-headless o jugando)
+    int keyframeInterval = 600;         // --keyframe-interval N: ticks entre estados completos
+    const char* seekPath = nullptr;     // --state-seek FILE TICK: voy a un tick del archivo de estados y salgo
+    long long seekTick = 0;
+    const char* desyncA = nullptr;      // --desync A B: primer tick y campo en que difieren dos archivos de estados (o de grabaciones)
+    const char* desyncB = nullptr;
+    int netPlayer = -1;                 // --netplay PLAYER LOCALPORT REMOTEPORT: versus en red por UDP local
+    int netLocalPort = 0, netRemotePort = 0;
+    int inputDelay = 2;                 // --input-delay N: frames de demora de la entrada local
+    NetConditions net;                  // --net-latency MS, --net-jitter MS, --net-loss PCT: red simulada
+    int netplayTicks = 0;               // --netplay-ticks N: sin ventana, con piloto automático, N frames
+    int spectators = 0;                 // --spectate N: partido con N espectadores por UDP local y salgo
+    double spectateSeconds = 10.0;      // --spectate-seconds S: cuánto dura la transmisión
+    int spectatePort = 7100;            // --spectate-port P: puerto del servidor; los espectadores usan los siguientes
+    int benchEnvs = 0;                  // --bench-env N: N entornos en lote con acciones al azar y salgo
+    int checkEnvSteps = 0;              // --check-env STEPS: comparo VectorEnv contra update() y salgo
 };
 
-// Clase ECS para gestionar componentes
-class ECS {
-public:
-    std::unordered_map<int, Position> positions;
-    std::unordered_map<int, Velocity> velocities;
-    std::unordered_map<int, Color> colors;
-    std::unordered_map<int, Paddle> paddles;
-    std::unordered_map<int, Ball> balls;
-    std::unordered_map<int, Block> blocks;
+Options parseOptions(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--software") == 0) {
+            opt.software = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opt.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-tiles") == 0) {
+            opt.benchTiles = true;
+        } else if (strcmp(argv[i], "--threaded") == 0) {
+            opt.threaded = true;
+        } else if (strcmp(argv[i], "--sim-hz") == 0 && i + 1 < argc) {
+            opt.simHz = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--golden-record") == 0 && i + 1 < argc) {
+            opt.goldenRecord = argv[++i];
+        } else if (strcmp(argv[i], "--golden-check") == 0 && i + 1 < argc) {
+            opt.goldenCheck = argv[++i];
+        } else if (strcmp(argv[i], "--golden-images") == 0 && i + 1 < argc) {
+            opt.goldenImages = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            opt.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            opt.capturePath = argv[++i];
+        } else if (strcmp(argv[i], "--capture-export") == 0 && i + 2 < argc) {
+            opt.exportCapture = argv[++i];
+            opt.exportDir = argv[++i];
+        } else if (strcmp(argv[i], "--flat") == 0) {
+            opt.flat = true;
+        } else if (strcmp(argv[i], "--no-hud") == 0) {
+            opt.hud = false;
+        } else if (strcmp(argv[i], "--no-particles") == 0) {
+            opt.particles = false;
+        } else if (strcmp(argv[i], "--bench-particles") == 0 && i + 1 < argc) {
+            opt.benchParticles = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--level-screens") == 0 && i + 1 < argc) {
+            opt.levelScreens = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pace") == 0 && i + 1 < argc) {
+            if (!parsePaceMode(argv[++i], opt.pace)) {
+                std::cout << "Modo de ritmo desconocido: " << argv[i] << std::endl;
+            }
+        } else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            opt.telemetryPrefix = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            opt.tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--trace-frames") == 0 && i + 1 < argc) {
+            opt.traceFrames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--track-allocs") == 0) {
+            opt.trackAllocations = true;
+        } else if (strcmp(argv[i], "--alloc-strict") == 0) {
+            opt.trackAllocations = true;
+            opt.allocStrict = true;
+        } else if (strcmp(argv[i], "--alloc-warmup") == 0 && i + 1 < argc) {
+            opt.allocWarmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+            opt.headlessTicks = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            opt.scriptPath = argv[++i];
+        } else if (strcmp(argv[i], "--headless-worlds") == 0 && i + 1 < argc) {
+            opt.headlessWorlds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--server") == 0 && i + 1 < argc) {
+            opt.serverMatches = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--server-seconds") == 0 && i + 1 < argc) {
+            opt.serverSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--server-hz") == 0 && i + 1 < argc) {
+            opt.serverHz = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            opt.recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            opt.replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay-headless") == 0 && i + 1 < argc) {
+            opt.replayHeadlessPath = argv[++i];
+        } else if (strcmp(argv[i], "--state-stream") == 0 && i + 1 < argc) {
+            opt.statePath = argv[++i];
+        } else if (strcmp(argv[i], "--keyframe-interval") == 0 && i + 1 < argc) {
+            opt.keyframeInterval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--desync") == 0 && i + 2 < argc) {
+            opt.desyncA = argv[++i];
+            opt.desyncB = argv[++i];
+        } else if (strcmp(argv[i], "--state-seek") == 0 && i + 2 < argc) {
+            opt.seekPath = argv[++i];
+            opt.seekTick = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--netplay") == 0 && i + 3 < argc) {
+            opt.netPlayer = atoi(argv[++i]) != 0 ? 1 : 0;
+            opt.netLocalPort = atoi(argv[++i]);
+            opt.netRemotePort = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--input-delay") == 0 && i + 1 < argc) {
+            opt.inputDelay = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--net-latency") == 0 && i + 1 < argc) {
+            opt.net.latencyMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--net-jitter") == 0 && i + 1 < argc) {
+            opt.net.jitterMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc) {
+            opt.net.loss = atof(argv[++i]) / 100.0;
+        } else if (strcmp(argv[i], "--netplay-ticks") == 0 && i + 1 < argc) {
+            opt.netplayTicks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--spectate") == 0 && i + 1 < argc) {
+            opt.spectators = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--spectate-seconds") == 0 && i + 1 < argc) {
+            opt.spectateSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--spectate-port") == 0 && i + 1 < argc) {
+            opt.spectatePort = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-env") == 0 && i + 1 < argc) {
+            opt.benchEnvs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--check-env") == 0 && i + 1 < argc) {
+            opt.checkEnvSteps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            opt.perf = true;
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            opt.fps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            opt.seed = static_cast<unsigned>(strtoul(argv[++i], NULL, 10));
+        } else {
+            std::cout << "Opcion desconocida: " << argv[i] << std::endl;
+        }
+    }
+    if (opt.threads <= 0) opt.threads = SDL_GetCPUCount();
+    if (opt.simHz <= 0) opt.simHz = 120;
+    if (opt.levelScreens <= 0) opt.levelScreens = 1;
+    if (opt.fps <= 0) opt.fps = MAX_FPS;
+    if (opt.headlessWorlds <= 0) opt.headlessWorlds = 1;
+    if (opt.keyframeInterval <= 0) opt.keyframeInterval = 600;
+    return opt;
+}
+
+// Benchmark del rasterizador por tiles: resoluciones, cantidad de bloques e hilos
+int benchTiles() {
+    struct Resolution { int w, h; const char* name; };
+    const Resolution resolutions[] = { { 1920, 1080, "1080p" }, { 3840, 2160, "4K" } };
+    const int blockCounts[] = { 1000, 10000, 100000 };
+    const int threadCounts[] = { 1, 2, 4, 8, 16, 32 };
+    const int warmup = 5;
+    const int frames = 60;
+    const SDL_Color background = { 0x00, 0x00, 0x00, 0xFF };
+
+    std::cout << "resolucion,bloques,hilos,ms_por_frame,speedup" << std::endl;
+    for (const auto& res : resolutions) {
+        for (int blocks : blockCounts) {
+            srand(1234);
+            std::vector<RenderCommand> commands(blocks);
+            for (auto& cmd : commands) {
+                cmd.rect = { rand() % res.w - BLOCK_WIDTH / 2, rand() % res.h - BLOCK_HEIGHT / 2, BLOCK_WIDTH, BLOCK_HEIGHT };
+                cmd.color = getRandomColor();
+            }
 
-    int createEntity() {
-        static int id = 0;
-        return id++;
+            double singleThreadMs = 0.0;
+            for (int threads : threadCounts) {
+                WorkerPool pool(threads);
+                TileRenderer tiles(res.w, res.h, pool);
+                for (int i = 0; i < warmup; ++i) {
+                    tiles.render(commands.data(), blocks, background);
+                }
+
+                Uint64 start = SDL_GetPerformanceCounter();
+                for (int i = 0; i < frames; ++i) {
+                    tiles.render(commands.data(), blocks, background);
+                }
+                Uint64 end = SDL_GetPerformanceCounter();
+
+                double ms = (end - start) * 1000.0 / SDL_GetPerformanceFrequency() / frames;
+                if (threads == 1) singleThreadMs = ms;
+                std::cout << res.name << "," << blocks << "," << threads << "," << ms << "," << singleThreadMs / ms << std::endl;
+            }
+        }
     }
+    return 0;
+}
+
+// Simulación en su propio hilo, publicando fotos en un triple buffer
+struct SimulationThread {
+    ECS* ecs;
+    TripleBuffer<RenderSnapshot>* snapshots;
+    int hz;
+    SDL_atomic_t input;   // botones que muestrea el hilo principal
+    SDL_atomic_t status;  // GameStatus al terminar
+    SDL_atomic_t quit;
+    Uint64 ticks;
+    ReplayRecorder* recorder; // nullptr si no se graba
 };
 
-SDL_Color getRandomColor() {
-    return { static_cast<Uint8>(rand() % 256), static_cast<Uint8>(rand() % 256), static_cast<Uint8>(rand() % 256), 0xFF };
-}
+int SDLCALL simulationMain(void* data) {
+    SimulationThread& sim = *static_cast<SimulationThread*>(data);
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const Uint64 step = freq / sim.hz;
+    const float dT = 1.0f / sim.hz;
+    const Uint64 margin = calibrateSleepOvershoot();
+    Uint64 next = SDL_GetPerformanceCounter();
+    bool unread = false;
+
+    while (!SDL_AtomicGet(&sim.quit)) {
+        PROFILE_ZONE("simulation.tick");
+        Uint32 input = static_cast<Uint32>(SDL_AtomicGet(&sim.input));
+        if (sim.recorder) sim.recorder->record(input, dT);
+        applyInput(*sim.ecs, input);
+        GameStatus status = update(*sim.ecs, dT);
+        if (sim.recorder) sim.recorder->recordHash(*sim.ecs);
+        ++sim.ticks;
+
+        RenderSnapshot& snapshot = sim.snapshots->writeBuffer();
+        buildSnapshot(*sim.ecs, snapshot, unread);
+        snapshot.tick = sim.ticks;
+        snapshot.publishedAt = SDL_GetPerformanceCounter();
+        unread = sim.snapshots->publish();
+
+        if (status != GameStatus::Running) {
+            SDL_AtomicSet(&sim.status, static_cast<int>(status));
+            break;
+        }
 
-// Inicializo bloques con ECS
-void initializeBlocks(ECS &ecs) {
-    for (int i = 0; i < BLOCK_ROWS; ++i) {
-        for (int j = 0; j < BLOCK_COLUMNS; ++j) {
-            int block = ecs.createEntity();
-            ecs.positions[block] = { j * (BLOCK_WIDTH + 10) + 35.0f, i * (BLOCK_HEIGHT + 10) + 30.0f };
-            ecs.colors[block] = { getRandomColor() };
-            ecs.blocks[block] = { true };
+        next += step;
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now < next) {
+            sleepUntil(next, margin);
+        } else if (now - next > step * 8) {
+            next = now; // me atrasé demasiado, no intento recuperar los ticks perdidos
         }
     }
+    return 0;
 }
 
-// Inicializo entidades ECS
-void initializeEntities(ECS &ecs) {
-    int paddle = ecs.createEntity();
-    ecs.positions[paddle] = { (SCREEN_WIDTH - PADDLE_WIDTH) / 2.0f, SCREEN_HEIGHT - PADDLE_HEIGHT - 10.0f };
-    ecs.velocities[paddle] = { 0.0f, 0.0f };
-    ecs.colors[paddle] = { {0xFF, 0xFF, 0xFF, 0xFF} };
-    ecs.paddles[paddle] = {};
-
-    int ball = ecs.createEntity();
-    ecs.positions[ball] = { SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f };
-    ecs.velocities[ball] = { BALL_SPEED, BALL_SPEED };
-    ecs.colors[ball] = { {0xFF, 0xFF, 0xFF, 0xFF} };
-    ecs.balls[ball] = {};
-
-    initializeBlocks(ecs);
+// Cierro la cuenta de asignaciones del frame; false si hay que cortar la corrida
+bool endAllocationFrame(AllocationTracker* allocations) {
+    if (!allocations) return true;
+    bool ok = allocations->endFrame();
+    if (allocations->steady()) profiler().setSteady();
+    return ok;
 }
 
-// Manejo de la entrada
-void handleInput(ECS &ecs, SDL_Event& e) {
-    const Uint8* ks = SDL_GetKeyboardState(NULL);
+// Bucle con simulación y render desacoplados. El render siempre dibuja la foto
+// más nueva; mido cuánto tiempo pasa desde que la simulación la publica hasta
+// que se presenta, y cuántos frames repiten foto o se saltan ticks.
+GameStatus runThreaded(ECS &ecs, RenderContext& renderCtx, FramePacer& pacer, Telemetry& telemetry,
+                       AllocationTracker* allocations, FrameCapture* capture, ReplayRecorder* recorder, const Options& options) {
+    TripleBuffer<RenderSnapshot> snapshots;
+    SimulationThread sim;
+    sim.ecs = &ecs;
+    sim.snapshots = &snapshots;
+    sim.hz = options.simHz;
+    sim.ticks = 0;
+    sim.recorder = recorder;
+    SDL_AtomicSet(&sim.input, 0);
+    SDL_AtomicSet(&sim.status, static_cast<int>(GameStatus::Running));
+    SDL_AtomicSet(&sim.quit, 0);
+
+    // Primera foto antes de arrancar el hilo, para tener algo que dibujar
+    buildSnapshot(ecs, snapshots.writeBuffer());
+    snapshots.writeBuffer().publishedAt = SDL_GetPerformanceCounter();
+    snapshots.publish();
+
+    SDL_Thread* thread = SDL_CreateThread(simulationMain, "simulation", &sim);
+
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const Uint64 runStart = SDL_GetPerformanceCounter();
+    Uint64 frames = 0, repeatedFrames = 0, skippedTicks = 0, lastTick = 0;
+    double ageSumMs = 0.0, ageMaxMs = 0.0;
+    FpsCounter fps;
+    bool quit = false;
+    SDL_Event e;
 
-    for (auto& paddle : ecs.paddles) {
-        ecs.velocities[paddle.first].vx = 0.0f;
+    while (!quit && SDL_AtomicGet(&sim.status) == static_cast<int>(GameStatus::Running)) {
+        float frameDt = pacer.beginFrame();
+        profiler().beginFrame();
+        if (allocations) allocations->beginFrame();
+        FrameTiming timing = { frames, {} };
+        Uint64 t0 = SDL_GetPerformanceCounter();
+
+        {
+            PROFILE_ZONE("input");
+            while (SDL_PollEvent(&e) != 0) {
+                if (e.type == SDL_QUIT) {
+                    quit = true;
+                }
+                if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F12) {
+                    telemetry.requestExport();
+                }
+                if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F11) {
+                    profiler().dumpNow();
+                }
+            }
+            SDL_AtomicSet(&sim.input, static_cast<int>(readInput()));
+        }
+        Uint64 t1 = SDL_GetPerformanceCounter();
+
+        // La simulación corre en su hilo; acá "update" es tomar la foto y avanzar las partículas
+        bool fresh = snapshots.acquire();
+        if (fresh) {
+            const RenderSnapshot& snapshot = snapshots.readBuffer();
+            if (lastTick != 0 && snapshot.tick > lastTick + 1) skippedTicks += snapshot.tick - lastTick - 1;
+            lastTick = snapshot.tick;
+        } else {
+            ++repeatedFrames;
+        }
 
-        if (ks[SDL_SCANCODE_LEFT]) {
-            ecs.velocities[paddle.first].vx = -PADDLE_SPEED;
+        const RenderSnapshot& snapshot = snapshots.readBuffer();
+        if (renderCtx.particles) {
+            // Los eventos de una foto se emiten una sola vez
+            static const RenderSnapshot noEvents;
+            updateParticles(*renderCtx.particles, fresh ? snapshot : noEvents, frameDt);
         }
-        if (ks[SDL_SCANCODE_RIGHT]) {
-            ecs.velocities[paddle.first].vx = PADDLE_SPEED;
+        Uint64 t2 = SDL_GetPerformanceCounter();
+        if (renderCtx.hud) updateHud(*renderCtx.hud, snapshot, fps);
+        render(snapshot, renderCtx);
+        if (capture) captureFrame(*capture, renderCtx);
+        Uint64 t3 = SDL_GetPerformanceCounter();
+        {
+            PROFILE_ZONE("present");
+            SDL_RenderPresent(renderCtx.renderer);
+        }
+        Uint64 t4 = SDL_GetPerformanceCounter();
+        fps.frame(SDL_GetTicks());
+        ++frames;
+
+        double ageMs = (t4 - snapshot.publishedAt) * 1000.0 / freq;
+        ageSumMs += ageMs;
+        if (ageMs > ageMaxMs) ageMaxMs = ageMs;
+
+        pacer.endFrame();
+        timing.us[PHASE_INPUT] = elapsedUs(t0, t1);
+        timing.us[PHASE_UPDATE] = elapsedUs(t1, t2);
+        timing.us[PHASE_RENDER] = elapsedUs(t2, t3);
+        timing.us[PHASE_PRESENT] = elapsedUs(t3, t4);
+        timing.us[PHASE_FRAME] = elapsedUs(t0, SDL_GetPerformanceCounter());
+        telemetry.record(timing);
+        if (!endAllocationFrame(allocations)) {
+            quit = true;
         }
     }
+
+    SDL_AtomicSet(&sim.quit, 1);
+    SDL_WaitThread(thread, NULL);
+
+    double seconds = (SDL_GetPerformanceCounter() - runStart) / static_cast<double>(freq);
+    std::cout << "Simulacion: " << sim.ticks / seconds << " ticks/s, render: " << frames / seconds << " FPS" << std::endl;
+    std::cout << "Edad de la foto al presentar: promedio " << (frames ? ageSumMs / frames : 0.0)
+              << " ms, maximo " << ageMaxMs << " ms" << std::endl;
+    std::cout << "Frames que repiten foto: " << repeatedFrames << ", ticks nunca dibujados: " << skippedTicks << std::endl;
+
+    return static_cast<GameStatus>(SDL_AtomicGet(&sim.status));
 }
 
-// Verifico colisiones
-bool checkCollision(Position& aPos, Position& bPos, int bWidth, int bHeight) {
-    return aPos.x < bPos.x + bWidth && aPos.x + BALL_SIZE > bPos.x && aPos.y < bPos.y + bHeight && aPos.y + BALL_SIZE > bPos.y;
+// Corrida golden: sin ventana, con el renderer por software de SDL sobre una
+// surface, dT fijo y piloto automático para que cada frame sea reproducible.
+// Si la partida termina, reinicio el mundo con la misma semilla y sigo.
+int runGolden(const Options& options) {
+    const bool recording = options.goldenRecord != nullptr;
+    const char* logPath = recording ? options.goldenRecord : options.goldenCheck;
+
+    std::vector<FrameHash> golden;
+    if (!recording && !readGoldenLog(logPath, golden, options.frames)) {
+        std::cout << "No pude leer el log golden " << logPath << " (o tiene frames mas alla de --frames " << options.frames << ")" << std::endl;
+        return 1;
+    }
+    FILE* log = fopen(recording ? logPath : (std::string(logPath) + ".actual").c_str(), "w");
+    if (!log) {
+        std::cout << "No pude escribir el log de hashes" << std::endl;
+        return 1;
+    }
+
+    SDL_Init(0);
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    WorkerPool pool(1);
+    RenderContext renderCtx;
+    renderCtx.renderer = SDL_CreateSoftwareRenderer(target);
+    if (!options.flat) renderCtx.atlas = createAtlas(renderCtx.renderer);
+    renderCtx.pool = &pool;
+    renderCtx.commands.setWorkers(pool.size());
+
+    FrameHasher hasher(SCREEN_WIDTH, SCREEN_HEIGHT);
+    RenderSnapshot snapshot;
+    srand(options.seed);
+    ECS ecs;
+    initializeEntities(ecs, options.levelScreens);
+    const char* dumpDir = options.goldenImages ? options.goldenImages : ".";
+
+    const float dT = 1.0f / MAX_FPS;
+    const int maxDumps = 8;
+    int mismatches = 0;
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (int frame = 0; frame < options.frames; ++frame) {
+        applyInput(ecs, autopilotInput(ecs));
+        if (update(ecs, dT) != GameStatus::Running) {
+            srand(options.seed);
+            ecs = ECS();
+            initializeEntities(ecs, options.levelScreens);
+        }
+
+        buildSnapshot(ecs, snapshot);
+        render(snapshot, renderCtx);
+        hasher.capture(renderCtx.renderer);
+        FrameHash h = hasher.hash();
+        writeFrameHash(log, frame, h);
+
+        if (recording) {
+            if (options.goldenImages) {
+                SDL_Surface* surface = hasher.surface();
+                SDL_SaveBMP(surface, goldenFramePath(options.goldenImages, "golden", frame).c_str());
+                SDL_FreeSurface(surface);
+            }
+        } else if (static_cast<size_t>(frame) >= golden.size() || h != golden[frame]) {
+            if (mismatches < maxDumps) dumpMismatch(hasher, dumpDir, frame);
+            ++mismatches;
+        }
+    }
+
+    double seconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+    std::cout << options.frames << " frames en " << seconds << " s (" << options.frames / seconds << " frames/s)" << std::endl;
+    if (!recording) {
+        std::cout << mismatches << " frames distintos al log golden" << std::endl;
+    }
+
+    fclose(log);
+    delete renderCtx.atlas;
+    SDL_DestroyRenderer(renderCtx.renderer);
+    SDL_FreeSurface(target);
+    SDL_Quit();
+    return mismatches == 0 ? 0 : 1;
 }
 
-// Actualizo el estado del juego
-void update(ECS &ecs, float dT) {
-    for (auto& paddle : ecs.paddles) {
-        auto& pos = ecs.positions[paddle.first];
-        auto& vel = ecs.velocities[paddle.first];
+// Solo simulación: sin ventana, sin render y sin esperas, con dT = 1/--sim-hz.
+// Cada mundo corre hasta --headless ticks o hasta que su partida termine.
+int runHeadlessMode(const Options& options) {
+    InputScript script;
+    if (options.scriptPath && !script.load(options.scriptPath)) {
+        std::cout << "No pude leer el guion " << options.scriptPath << std::endl;
+        return 1;
+    }
 
-        pos.x += vel.vx * dT;
-        if (pos.x < 0) pos.x = 0;
-        if (pos.x + PADDLE_WIDTH > SCREEN_WIDTH) pos.x = SCREEN_WIDTH - PADDLE_WIDTH;
+    SDL_Init(0);
+    if (options.perf) perfCounters().start();
+    std::vector<ECS> worlds(options.headlessWorlds);
+    std::vector<HeadlessJob> jobs(options.headlessWorlds);
+    for (int i = 0; i < options.headlessWorlds; ++i) {
+        srand(options.seed);
+        initializeEntities(worlds[i], options.levelScreens);
+        jobs[i] = { &worlds[i], static_cast<Uint64>(options.headlessTicks), 1.0f / options.simHz,
+                    options.scriptPath ? &script : nullptr, {} };
     }
 
-    for (auto& ball : ecs.balls) {
-        auto& pos = ecs.positions[ball.first];
-        auto& vel = ecs.velocities[ball.first];
+    Uint64 start = SDL_GetPerformanceCounter();
+    runHeadlessParallel(jobs);
+    double seconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
 
-        pos.x += vel.vx * dT;
-        pos.y += vel.vy * dT;
+    Uint64 totalTicks = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const HeadlessResult& r = jobs[i].result;
+        totalTicks += r.ticks;
+        printf("mundo %zu: %s en el tick %llu, puntaje %d, quedan %d bloques, %.0f ticks/s\n", i, gameStatusName(r.status),
+               static_cast<unsigned long long>(r.ticks), r.score, r.blocksLeft, r.seconds > 0.0 ? r.ticks / r.seconds : 0.0);
+    }
+    printf("Total: %llu ticks en %.3f s, %.0f ticks/s (%d hilos)\n", static_cast<unsigned long long>(totalTicks), seconds,
+           seconds > 0.0 ? totalTicks / seconds : 0.0, options.headlessWorlds);
+    perfCounters().printReport();
+    SDL_Quit();
+    return 0;
+}
 
-        if (pos.x < 0 || pos.x + BALL_SIZE > SCREEN_WIDTH) {
-            vel.vx *= -1;
+// Reproduzco una grabación lo más rápido posible y verifico que termine igual
+int runReplayHeadless(const char* path, const Options& options) {
+    ReplayReader replay;
+    if (!replay.load(path)) {
+        std::cout << "No pude leer la grabacion " << path << std::endl;
+        return 1;
+    }
+    SDL_Init(0);
+    ECS ecs;
+    startReplay(replay, ecs);
+    StateStreamWriter* stream = nullptr;
+    if (options.statePath) {
+        stream = new StateStreamWriter(options.statePath, options.keyframeInterval);
+        if (!stream->ok()) {
+            std::cout << "No pude abrir " << options.statePath << " para los estados" << std::endl;
+            delete stream;
+            stream = nullptr;
         }
-        if (pos.y < 0) {
-            vel.vy *= -1;
+    }
+    HeadlessResult r = replayHeadless(replay, ecs, stream);
+    delete stream;
+    bool same = replayMatches(replay, r);
+    printf("Reproduccion: %s en el tick %llu, puntaje %d, quedan %d bloques, %.0f ticks/s, %s\n", gameStatusName(r.status),
+           static_cast<unsigned long long>(r.ticks), r.score, r.blocksLeft, r.seconds > 0.0 ? r.ticks / r.seconds : 0.0,
+           same ? "igual que la grabacion" : "DISTINTA a la grabacion");
+    replay.printMismatch();
+    if (!replay.hasHashes()) std::cout << "(la grabacion no tiene hashes por tick)" << std::endl;
+    SDL_Quit();
+    return same ? 0 : 1;
+}
+
+// Versus contra otro proceso por UDP en 127.0.0.1, con rollback. Con
+// --netplay-ticks corre sin ventana y con el piloto automático.
+int runNetplay(const Options& options) {
+    const bool headless = options.netplayTicks > 0;
+    SDL_Init(headless ? 0 : SDL_INIT_VIDEO);
+    srand(options.seed); // los dos tienen que arrancar del mismo nivel
+    ECS ecs;
+    initializeVersus(ecs);
+    NetLink link(options.net);
+    if (!link.open(options.netLocalPort, options.netRemotePort)) {
+        std::cout << "No pude abrir el puerto UDP " << options.netLocalPort << std::endl;
+        SDL_Quit();
+        return 1;
+    }
+    RollbackSession session(ecs, link, options.netPlayer, options.inputDelay);
+    std::cout << "Jugador " << options.netPlayer << " esperando al otro en el puerto " << options.netRemotePort << "..." << std::endl;
+    if (!session.connect(30.0)) {
+        std::cout << "El otro jugador no aparecio" << std::endl;
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Window* window = nullptr;
+    RenderContext renderCtx;
+    WorkerPool* pool = nullptr;
+    if (!headless) {
+        window = SDL_CreateWindow(options.netPlayer == 0 ? "Breakout versus: jugador 0 (abajo)" : "Breakout versus: jugador 1 (arriba)",
+                                  SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+        renderCtx.renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+        pool = new WorkerPool(1);
+        renderCtx.pool = pool;
+        renderCtx.commands.setWorkers(pool->size());
+        renderCtx.atlas = createAtlas(renderCtx.renderer);
+    }
+
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const Uint64 step = freq / NETPLAY_HZ;
+    const Uint64 margin = calibrateSleepOvershoot();
+    Uint64 next = SDL_GetPerformanceCounter();
+    RenderSnapshot snapshot;
+    bool quit = false;
+    SDL_Event e;
+    while (!quit && !session.finished()) {
+        while (SDL_PollEvent(&e) != 0) {
+            if (e.type == SDL_QUIT) quit = true;
         }
-        if (pos.y + BALL_SIZE > SCREEN_HEIGHT) {
-            std::cout << "Game Over" << std::endl;
-            SDL_Quit();
-            exit(0);
+        if (headless && session.getFrame() >= options.netplayTicks) break;
+        Uint32 buttons = headless ? autopilotInput(ecs, options.netPlayer) >> (INPUT_BITS * options.netPlayer) : readInput();
+        session.advance(buttons);
+        if (session.peerSilent(3.0)) {
+            std::cout << "El otro jugador se desconecto" << std::endl;
+            break;
         }
-
-        for (auto& paddle : ecs.paddles) {
-            if (checkCollision(pos, ecs.positions[paddle.first], PADDLE_WIDTH, PADDLE_HEIGHT)) {
-                vel.vy *= -1;
-                pos.y = ecs.positions[paddle.first].y - BALL_SIZE;
-            }
+        if (!headless) {
+            buildSnapshot(ecs, snapshot);
+            render(snapshot, renderCtx);
+            SDL_RenderPresent(renderCtx.renderer);
         }
+        next += step;
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now < next) sleepUntil(next, margin);
+        else next = now;
+    }
 
-        for (auto& block : ecs.blocks) {
-            if (block.second.active && checkCollision(pos, ecs.positions[block.first], BLOCK_WIDTH, BLOCK_HEIGHT)) {
-                vel.vy *= -1;
-                block.second.active = false;
-            }
-        }
+    // Sigo mandando un rato para que al otro le lleguen mis últimas entradas,
+    // y espero las suyas para que el resultado quede confirmado
+    const Uint64 lingerEnd = SDL_GetPerformanceCounter() + freq;
+    const Uint64 confirmEnd = SDL_GetPerformanceCounter() + 3 * freq;
+    for (;;) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now >= confirmEnd || (now >= lingerEnd && session.confirmed())) break;
+        session.pump();
+        SDL_Delay(5);
+    }
 
-        bool allDestroyed = true;
-        for (const auto& block : ecs.blocks) {
-            if (block.second.active) {
-                allDestroyed = false;
-                break;
-            }
-        }
+    session.printStats();
+    int paddles[2] = { findPaddle(ecs, 0), findPaddle(ecs, 1) };
+    printf("Frame %d%s: tantos %d a %d, puntaje %d, quedan %d bloques\n", session.getFrame(),
+           session.confirmed() ? "" : " (sin confirmar)", ecs.paddles[paddles[0]].points, ecs.paddles[paddles[1]].points, ecs.score,
+           ecs.blocksLeft);
+    if (session.finished()) {
+        int p0 = ecs.paddles[paddles[0]].points, p1 = ecs.paddles[paddles[1]].points;
+        std::cout << (p0 == p1 ? "Empate" : (p0 > p1) == (options.netPlayer == 0) ? "Ganaste" : "Perdiste") << std::endl;
+    }
 
-        if (allDestroyed) {
-            std::cout << "You Win!" << std::endl;
-            SDL_Delay(2000);
-            SDL_Quit();
-            exit(0);
-        }
+    if (!headless) {
+        delete renderCtx.atlas;
+        delete pool;
+        SDL_DestroyRenderer(renderCtx.renderer);
+        SDL_DestroyWindow(window);
     }
+    SDL_Quit();
+    return session.getDesyncFrame() >= 0 ? 2 : 0;
 }
 
-// Renderizo el juego con ECS
-void render(ECS &ecs, SDL_Renderer* renderer) {
-    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
-    SDL_RenderClear(renderer);
-
-    for (const auto& paddle : ecs.paddles) {
-        auto& pos = ecs.positions[paddle.first];
-        auto& color = ecs.colors[paddle.first];
-        SDL_SetRenderDrawColor(renderer, color.color.r, color.color.g, color.color.b, color.color.a);
-        SDL_Rect rect = { static_cast<int>(pos.x), static_cast<int>(pos.y), PADDLE_WIDTH, PADDLE_HEIGHT };
-        SDL_RenderFillRect(renderer, &rect);
-    }
-
-    for (const auto& ball : ecs.balls) {
-        auto& pos = ecs.positions[ball.first];
-        auto& color = ecs.colors[ball.first];
-        SDL_SetRenderDrawColor(renderer, color.color.r, color.color.g, color.color.b, color.color.a);
-        SDL_Rect rect = { static_cast<int>(pos.x), static_cast<int>(pos.y), BALL_SIZE, BALL_SIZE };
-        SDL_RenderFillRect(renderer, &rect);
-    }
-
-    for (const auto& block : ecs.blocks) {
-        if (block.second.active) {
-            auto& pos = ecs.positions[block.first];
-            auto& color = ecs.colors[block.first];
-            SDL_SetRenderDrawColor(renderer, color.color.r, color.color.g, color.color.b, color.color.a);
-            SDL_Rect rect = { static_cast<int>(pos.x), static_cast<int>(pos.y), BLOCK_WIDTH, BLOCK_HEIGHT };
-            SDL_RenderFillRect(renderer, &rect);
+// Dónde se separan dos corridas. Con dos archivos de estados (--state-stream)
+// comparo tick por tick hasta el primero distinto y muestro qué entidades y campos cambian; con
+// dos grabaciones solo se puede comparar el hash de cada tick.
+int runDesync(const char* pathA, const char* pathB) {
+    SDL_Init(0);
+    StateStreamReader streamA, streamB;
+    if (streamA.open(pathA) && streamB.open(pathB)) {
+        std::vector<Uint32> wordsA, wordsB;
+        Uint64 start = SDL_GetPerformanceCounter();
+        long long tick = firstStateDifference(streamA, streamB, wordsA, wordsB);
+        double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+        SDL_Quit();
+        if (tick == -2) {
+            std::cout << "No pude leer los estados" << std::endl;
+            return 1;
+        }
+        if (tick == -1) {
+            printf("Coinciden en los %llu ticks que tienen los dos (%llu y %llu ticks)\n",
+                   static_cast<unsigned long long>(streamA.getTicks() < streamB.getTicks() ? streamA.getTicks() : streamB.getTicks()),
+                   static_cast<unsigned long long>(streamA.getTicks()), static_cast<unsigned long long>(streamB.getTicks()));
+            return 0;
         }
+        printf("Primer tick distinto: %lld (%.3f ms)\n", tick, ms);
+        printStateDifference(wordsA, wordsB);
+        return 2;
+    }
+
+    ReplayReader replayA, replayB;
+    if (!replayA.load(pathA) || !replayB.load(pathB)) {
+        std::cout << "Hacen falta dos archivos de estados o dos grabaciones" << std::endl;
+        SDL_Quit();
+        return 1;
     }
+    SDL_Quit();
+    if (!replayA.hasHashes() || !replayB.hasHashes()) {
+        std::cout << "Alguna de las grabaciones no tiene hashes por tick" << std::endl;
+        return 1;
+    }
+    const std::vector<Uint32>& a = replayA.getHashes();
+    const std::vector<Uint32>& b = replayB.getHashes();
+    const size_t common = a.size() < b.size() ? a.size() : b.size();
+    for (size_t i = 0; i < common; ++i) {
+        if (a[i] == b[i]) continue;
+        printf("Primer tick distinto: %zu (hash %08x contra %08x)\n", i, a[i], b[i]);
+        std::cout << "Para ver que cambia: --replay-headless con --state-stream en cada lado y --desync con los dos archivos" << std::endl;
+        return 2;
+    }
+    printf("Coinciden en los %zu ticks que tienen las dos (%zu y %zu ticks)\n", common, a.size(), b.size());
+    return 0;
+}
 
-    SDL_RenderPresent(renderer);
+// Voy a un tick de un archivo de estados y muestro cómo estaba el mundo
+int runStateSeek(const char* path, long long tick) {
+    SDL_Init(0);
+    StateStreamReader reader;
+    if (!reader.open(path)) {
+        std::cout << "No pude leer el archivo de estados " << path << std::endl;
+        SDL_Quit();
+        return 1;
+    }
+    ECS ecs;
+    Uint64 start = SDL_GetPerformanceCounter();
+    bool ok = tick >= 0 && reader.seek(static_cast<Uint64>(tick), ecs);
+    double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    if (!ok) {
+        printf("No pude ir al tick %lld (el archivo tiene %llu ticks)\n", tick, static_cast<unsigned long long>(reader.getTicks()));
+        SDL_Quit();
+        return 1;
+    }
+    printf("Tick %lld de %llu (%llu keyframes) en %.3f ms: puntaje %d, quedan %d bloques\n", tick,
+           static_cast<unsigned long long>(reader.getTicks()), static_cast<unsigned long long>(reader.getKeyframes()), ms, ecs.score,
+           ecs.blocksLeft);
+    for (const auto& b : ecs.balls) {
+        const Position& p = ecs.positions[b.first];
+        const Velocity& v = ecs.velocities[b.first];
+        printf("  pelota %d en (%.2f, %.2f) a (%.2f, %.2f)\n", b.first, p.x, p.y, v.vx, v.vy);
+    }
+    for (const auto& paddle : ecs.paddles) {
+        printf("  paddle %d en x %.2f\n", paddle.first, ecs.positions[paddle.first].x);
+    }
+    SDL_Quit();
+    return 0;
 }
 
 // Función principal
 int main(int argc, char* argv[]) {
+    Options options = parseOptions(argc, argv);
+    if (options.benchTiles) {
+        return benchTiles();
+    }
+    if (options.goldenRecord || options.goldenCheck) {
+        return runGolden(options);
+    }
+    if (options.exportCapture) {
+        return exportCapture(options.exportCapture, options.exportDir);
+    }
+    if (options.benchParticles > 0) {
+        return benchParticles(options.benchParticles, 600);
+    }
+    if (options.headlessTicks > 0) {
+        return runHeadlessMode(options);
+    }
+    if (options.replayHeadlessPath) {
+        return runReplayHeadless(options.replayHeadlessPath, options);
+    }
+    if (options.spectators > 0) {
+        SDL_Init(0);
+        int result = runSpectators(options.spectators, options.spectateSeconds, options.spectatePort, options.seed, options.net);
+        SDL_Quit();
+        return result;
+    }
+    if (options.netPlayer >= 0) {
+        return runNetplay(options);
+    }
+    if (options.seekPath) {
+        return runStateSeek(options.seekPath, options.seekTick);
+    }
+    if (options.desyncA) {
+        return runDesync(options.desyncA, options.desyncB);
+    }
+    if (options.serverMatches > 0) {
+        SDL_Init(0);
+        MatchServer server(options.serverMatches, options.threads, options.serverHz, options.levelScreens);
+        server.run(options.serverSeconds);
+        server.printReport();
+        SDL_Quit();
+        return 0;
+    }
+    if (options.benchEnvs > 0) {
+        return benchVectorEnv(options.benchEnvs, 1000, options.threads);
+    }
+    if (options.checkEnvSteps > 0) {
+        return checkVectorEnv(7, options.checkEnvSteps); // 7: grupos de 4 con SSE2 y el resto uno por uno
+    }
+
+    if (options.trackAllocations) trackSDLAllocations();
     SDL_Init(SDL_INIT_VIDEO);
+    srand(options.seed);
+    if (options.tracePath || options.trackAllocations) profiler().start(options.tracePath, options.traceFrames);
+    if (options.perf) perfCounters().start();
 
     SDL_Window* window = SDL_CreateWindow("Game Loops: Breakout", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
     SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
 
-    ECS ecs; //Usando ECS para inicializar
-    initializeEntities(ecs);
+    WorkerPool* pool = new WorkerPool(options.threads);
+    RenderContext renderCtx;
+    renderCtx.renderer = renderer;
+    renderCtx.pool = pool;
+    renderCtx.commands.setWorkers(pool->size());
+    if (options.software) {
+        renderCtx.tiles = new TileRenderer(SCREEN_WIDTH, SCREEN_HEIGHT, *pool);
+        renderCtx.tileTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
+    } else if (!options.flat) {
+        renderCtx.atlas = createAtlas(renderer);
+    }
+    if (options.particles) {
+        renderCtx.particles = new ParticleSystem(MAX_PARTICLES);
+    }
+    if (options.hud) {
+        renderCtx.hud = new Hud();
+        if (!renderCtx.hud->init(renderer)) {
+            delete renderCtx.hud;
+            renderCtx.hud = nullptr;
+        }
+    }
 
-    bool quit = false;
-    SDL_Event e;
+    FrameCapture* capture = nullptr;
+    if (options.capturePath) {
+        capture = new FrameCapture(options.capturePath, SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (!capture->ok()) {
+            std::cout << "No pude abrir " << options.capturePath << " para la captura" << std::endl;
+        }
+    }
 
-    Uint32 frameStartTimestamp;
-    Uint32 frameEndTimestamp;
-    Uint32 lastFrameTime = SDL_GetTicks();
-    Uint32 lastUpdateTime = 0;
-    float frameDuration = (1.0f / MAX_FPS) * 1000.0f;
-    float actualFrameDuration;
-    int FPS = MAX_FPS;
+    ECS ecs; //Usando ECS para inicializar
+    ReplayReader* replay = nullptr;
+    if (options.replayPath) {
+        replay = new ReplayReader();
+        if (!replay->load(options.replayPath)) {
+            std::cout << "No pude leer la grabacion " << options.replayPath << std::endl;
+            delete replay;
+            replay = nullptr;
+        }
+    }
+    if (replay) {
+        startReplay(*replay, ecs);
+    } else {
+        initializeEntities(ecs, options.levelScreens);
+    }
+    ReplayRecorder* recorder = nullptr;
+    if (options.recordPath && !replay) {
+        recorder = new ReplayRecorder(options.recordPath, options.seed, options.levelScreens);
+        if (!recorder->ok()) {
+            std::cout << "No pude abrir " << options.recordPath << " para grabar" << std::endl;
+            delete recorder;
+            recorder = nullptr;
+        }
+    }
 
-    while (!quit) {
-        frameStartTimestamp = SDL_GetTicks();
+    StateStreamWriter* stream = nullptr;
+    if (options.statePath) {
+        stream = new StateStreamWriter(options.statePath, options.keyframeInterval);
+        if (!stream->ok()) {
+            std::cout << "No pude abrir " << options.statePath << " para los estados" << std::endl;
+            delete stream;
+            stream = nullptr;
+        }
+    }
 
-        Uint32 currentFrameTime = SDL_GetTicks();
-        float dT = (currentFrameTime - lastFrameTime) / 1000.0f;
-        lastFrameTime = currentFrameTime;
+    FramePacer pacer(options.pace, options.fps);
+    pacer.attach(renderer);
+    Telemetry telemetry(options.telemetryPrefix); // F12 exporta en cualquier momento
+    AllocationTracker* allocations = options.trackAllocations ? new AllocationTracker(options.allocWarmup, options.allocStrict) : nullptr;
+
+    GameStatus status = GameStatus::Running;
+    RenderSnapshot snapshot;
+    bool threaded = options.threaded && !replay; // las grabaciones se reproducen en el bucle clásico
+    bool quit = threaded; // en modo --threaded el bucle clásico no corre
+    if (threaded) {
+        status = runThreaded(ecs, renderCtx, pacer, telemetry, allocations, capture, recorder, options);
+    }
+    SDL_Event e;
+    FpsCounter fps;
+    Uint64 frame = 0;
+    Uint32 heldInput = 0; // la última entrada que aplicó handleInput()
 
-        while (SDL_PollEvent(&e) != 0) {
-            if (e.type == SDL_QUIT) {
-                quit = true;
+    while (!quit) {
+        float dT = pacer.beginFrame();
+        profiler().beginFrame();
+        if (allocations) allocations->beginFrame();
+        FrameTiming timing = { frame++, {} };
+        Uint64 t0 = SDL_GetPerformanceCounter();
+
+        {
+            PROFILE_ZONE("input");
+            while (SDL_PollEvent(&e) != 0) {
+                if (e.type == SDL_QUIT) {
+                    quit = true;
+                }
+                if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F12) {
+                    telemetry.requestExport();
+                }
+                if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F11) {
+                    profiler().dumpNow();
+                }
+                if (!replay) heldInput = handleInput(ecs, e);
+            }
+            // Reproduciendo, la entrada y el dT salen de la grabación. Grabando,
+            // la entrada pasa por handleInput() como sin grabar y guardo la que
+            // quedó aplicada: update() no toca la velocidad del paddle, así que
+            // aplicarla de nuevo en cada tick al reproducir da lo mismo.
+            if (replay) {
+                Uint32 input;
+                if (!replay->next(input, dT)) break;
+                applyInput(ecs, input);
+            } else if (recorder) {
+                recorder->record(heldInput, dT);
             }
-            handleInput(ecs, e);
         }
-
-        update(ecs, dT);
-        render(ecs, renderer);
-
-        frameEndTimestamp = SDL_GetTicks();
-        actualFrameDuration = frameEndTimestamp - frameStartTimestamp;
-
-        if (actualFrameDuration < frameDuration) {
-            SDL_Delay(static_cast<Uint32>(frameDuration - actualFrameDuration));
+        Uint64 t1 = SDL_GetPerformanceCounter();
+
+        status = update(ecs, dT);
+        if (recorder) recorder->recordHash(ecs);
+        if (replay) replay->verify(ecs);
+        if (stream) stream->writeTick(ecs);
+        if (status != GameStatus::Running) {
+            break;
         }
-
-        Uint32 currentTime = SDL_GetTicks();
-        Uint32 elapsedTime = currentTime - lastUpdateTime;
-        if (elapsedTime > 1000) {
-            FPS = (float)lastFrameTime / (elapsedTime / 1000.0f);
-            lastUpdateTime = currentTime;
+        buildSnapshot(ecs, snapshot);
+        if (renderCtx.particles) updateParticles(*renderCtx.particles, snapshot, dT);
+        Uint64 t2 = SDL_GetPerformanceCounter();
+        if (renderCtx.hud) updateHud(*renderCtx.hud, snapshot, fps);
+        render(snapshot, renderCtx);
+        if (capture) captureFrame(*capture, renderCtx);
+        Uint64 t3 = SDL_GetPerformanceCounter();
+        {
+            PROFILE_ZONE("present");
+            SDL_RenderPresent(renderer);
         }
+        Uint64 t4 = SDL_GetPerformanceCounter();
+
+        pacer.endFrame();
+        fps.frame(SDL_GetTicks());
+        timing.us[PHASE_INPUT] = elapsedUs(t0, t1);
+        timing.us[PHASE_UPDATE] = elapsedUs(t1, t2);
+        timing.us[PHASE_RENDER] = elapsedUs(t2, t3);
+        timing.us[PHASE_PRESENT] = elapsedUs(t3, t4);
+        timing.us[PHASE_FRAME] = elapsedUs(t0, SDL_GetPerformanceCounter());
+        telemetry.record(timing);
+        if (!endAllocationFrame(allocations)) {
+            quit = true;
+        }
+    }
+    pacer.printStats();
+    profiler().finish();
+    telemetry.finish();
+    telemetry.printSummary();
+    perfCounters().printReport();
+    bool allocationFailure = false;
+    if (allocations) {
+        allocations->printStats();
+        profiler().printAllocations();
+        allocationFailure = allocations->failed();
+        delete allocations;
     }
 
+    if (recorder) {
+        recorder->finish(ecs, status);
+        delete recorder;
+    }
+    delete stream;
+    if (replay) {
+        HeadlessResult result = { status, replay->getTick(), 0.0, ecs.score, ecs.blocksLeft };
+        std::cout << "Reproduccion de " << replay->getTick() << " ticks: "
+                  << (replayMatches(*replay, result) ? "termina igual que la grabacion" : "NO termina igual que la grabacion") << std::endl;
+        replay->printMismatch();
+        delete replay;
+    }
+    if (status == GameStatus::GameOver) {
+        std::cout << "Game Over" << std::endl;
+    }
+    if (status == GameStatus::Won) {
+        std::cout << "You Win!" << std::endl;
+        SDL_Delay(2000);
+    }
+
+    if (capture) {
+        capture->finish();
+        capture->printStats();
+        delete capture;
+    }
+
+    if (renderCtx.tiles) {
+        SDL_DestroyTexture(renderCtx.tileTexture);
+        delete renderCtx.tiles;
+    }
+    if (renderCtx.hud) {
+        renderCtx.hud->printStats();
+        delete renderCtx.hud;
+    }
+    delete renderCtx.particles;
+    delete renderCtx.atlas;
+    delete pool;
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
+    if (options.trackAllocations) SDLTest_LogAllocations(); // lo que SDL no liberó
 
-    return 0;
+    return allocationFailure ? 1 : 0;
 }
@@ -0,0 +1,273 @@
+#ifndef BREAKOUT_TELEMETRY_H
+#define BREAKOUT_TELEMETRY_H
+
+#include "inc/SDL.h"
+#include "allocation.h"
+#include "inc/SDL_bits.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Partes de un frame que se miden; PHASE_FRAME es el frame completo con la espera
+enum TelemetryPhase { PHASE_INPUT, PHASE_UPDATE, PHASE_RENDER, PHASE_PRESENT, PHASE_FRAME, PHASE_COUNT };
+
+const char* const PHASE_NAMES[PHASE_COUNT] = { "input", "update", "render", "present", "frame" };
+
+// Un frame es hitch si dura más que HITCH_FACTOR veces el promedio reciente
+const double HITCH_FACTOR = 2.0;
+
+// Tiempos de un frame en microsegundos
+struct FrameTiming {
+    Uint64 frame;
+    Uint32 us[PHASE_COUNT];
+};
+
+// Histograma con precisión relativa fija (estilo HDR): valores chicos en
+// cubetas de a 1 y de ahí en adelante 64 cubetas por potencia de dos, o sea
+// menos de 1.6% de error sin importar la magnitud
+class HdrHistogram {
+public:
+    HdrHistogram() : buckets(LINEAR + 32 * HALF, 0), total(0), maxValue(0), sum(0) {}
+
+    void record(Uint32 value) {
+        ++buckets[index(value)];
+        ++total;
+        sum += value;
+        if (value > maxValue) maxValue = value;
+    }
+
+    // Valor (límite superior de la cubeta) por debajo del cual cae el p% de las muestras
+    Uint32 percentile(double p) const {
+        if (total == 0) return 0;
+        Uint64 target = static_cast<Uint64>(p / 100.0 * total + 0.5);
+        if (target < 1) target = 1;
+        Uint64 seen = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= target) {
+                Uint32 upper = upperBound(static_cast<int>(i));
+                return upper < maxValue ? upper : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    // Sumo las muestras de otro histograma (por ejemplo, el de otro hilo)
+    void add(const HdrHistogram& other) {
+        for (size_t i = 0; i < buckets.size(); ++i) buckets[i] += other.buckets[i];
+        total += other.total;
+        sum += other.sum;
+        if (other.maxValue > maxValue) maxValue = other.maxValue;
+    }
+
+    Uint64 count() const { return total; }
+    Uint32 max() const { return maxValue; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+
+private:
+    static const int LINEAR = 128;
+    static const int HALF = 64;
+
+    static int index(Uint32 v) {
+        if (v < LINEAR) return static_cast<int>(v);
+        int shift = SDL_MostSignificantBitIndex32(v) - 6; // v >> shift queda en [64, 128)
+        return LINEAR + (shift - 1) * HALF + static_cast<int>((v >> shift) - HALF);
+    }
+
+    static Uint32 upperBound(int i) {
+        if (i < LINEAR) return static_cast<Uint32>(i);
+        int shift = (i - LINEAR) / HALF + 1;
+        Uint64 sub = (i - LINEAR) % HALF + HALF;
+        Uint64 upper = ((sub + 1) << shift) - 1;
+        return upper > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<Uint32>(upper);
+    }
+
+    std::vector<Uint64> buckets;
+    Uint64 total;
+    Uint32 maxValue;
+    Uint64 sum;
+};
+
+// Cola SPSC de tamaño fijo; si está llena push() devuelve false
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(int capacity) : slots(capacity + 1) {
+        SDL_AtomicSet(&head, 0);
+        SDL_AtomicSet(&tail, 0);
+    }
+
+    bool push(const T& value) {
+        int t = SDL_AtomicGet(&tail);
+        int next = (t + 1) % static_cast<int>(slots.size());
+        if (next == SDL_AtomicGet(&head)) return false;
+        slots[t] = value;
+        SDL_AtomicSet(&tail, next);
+        return true;
+    }
+
+    bool pop(T& value) {
+        int h = SDL_AtomicGet(&head);
+        if (h == SDL_AtomicGet(&tail)) return false;
+        value = slots[h];
+        SDL_AtomicSet(&head, (h + 1) % static_cast<int>(slots.size()));
+        return true;
+    }
+
+private:
+    std::vector<T> slots;
+    SDL_atomic_t head, tail;
+};
+
+// Telemetría por frame. El bucle principal solo copia los tiempos a una cola
+// sin locks; un hilo aparte los vacía, arma los histogramas, detecta hitches y
+// exporta CSV (un renglón por frame) y JSON (percentiles y hitches) al salir o
+// cuando se pide con requestExport().
+class Telemetry {
+public:
+    explicit Telemetry(const char* prefix, int ringSize = 1024)
+        : prefix(prefix ? prefix : "telemetry"), exportOnFinish(prefix != nullptr), ring(ringSize),
+          dropped(0), exports(0), averageFrameUs(0.0) {
+        SDL_AtomicSet(&quit, 0);
+        SDL_AtomicSet(&exportRequested, 0);
+        wake = SDL_CreateSemaphore(0);
+        thread = SDL_CreateThread(consumerMain, "telemetry", this);
+    }
+
+    ~Telemetry() {
+        finish();
+        SDL_DestroySemaphore(wake);
+    }
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // Hilo principal, una vez por frame
+    void record(const FrameTiming& timing) {
+        if (!ring.push(timing)) ++dropped;
+    }
+
+    void requestExport() {
+        SDL_AtomicSet(&exportRequested, 1);
+        SDL_SemPost(wake);
+    }
+
+    // Vacío la cola, exporto si hay prefijo y termino el hilo
+    void finish() {
+        if (!thread) return;
+        if (exportOnFinish) SDL_AtomicSet(&exportRequested, 1);
+        SDL_AtomicSet(&quit, 1);
+        SDL_SemPost(wake);
+        SDL_WaitThread(thread, NULL);
+        thread = nullptr;
+    }
+
+    // Después de finish()
+    void printSummary() const {
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            const HdrHistogram& h = histograms[p];
+            printf("%-8s p50 %6.2f  p95 %6.2f  p99 %6.2f  p99.9 %6.2f  max %6.2f ms\n", PHASE_NAMES[p],
+                   h.percentile(50) / 1000.0, h.percentile(95) / 1000.0, h.percentile(99) / 1000.0,
+                   h.percentile(99.9) / 1000.0, h.max() / 1000.0);
+        }
+        const HdrHistogram& frame = histograms[PHASE_FRAME];
+        printf("Telemetria: %llu frames, %.1f FPS promedio, %zu hitches, %u muestras perdidas\n",
+               static_cast<unsigned long long>(frame.count()), frame.mean() > 0 ? 1e6 / frame.mean() : 0.0,
+               hitches.size(), dropped);
+    }
+
+    const HdrHistogram& histogram(TelemetryPhase phase) const { return histograms[phase]; }
+
+private:
+    static int SDLCALL consumerMain(void* data) {
+        static_cast<Telemetry*>(data)->consumerLoop();
+        return 0;
+    }
+
+    void consumerLoop() {
+        ignoreThreadAllocations();
+        for (;;) {
+            SDL_SemWaitTimeout(wake, 100);
+            drain();
+            if (SDL_AtomicSet(&exportRequested, 0)) exportFiles();
+            if (SDL_AtomicGet(&quit)) {
+                drain();
+                if (SDL_AtomicSet(&exportRequested, 0)) exportFiles();
+                return;
+            }
+        }
+    }
+
+    void drain() {
+        FrameTiming timing;
+        while (ring.pop(timing)) {
+            for (int p = 0; p < PHASE_COUNT; ++p) histograms[p].record(timing.us[p]);
+
+            // Hitch contra el promedio exponencial de los frames anteriores
+            double frameUs = timing.us[PHASE_FRAME];
+            if (averageFrameUs > 0.0 && frameUs > HITCH_FACTOR * averageFrameUs) hitches.push_back(timing);
+            averageFrameUs = averageFrameUs > 0.0 ? averageFrameUs * 0.95 + frameUs * 0.05 : frameUs;
+            frames.push_back(timing);
+        }
+    }
+
+    void exportFiles() {
+        std::string csvPath = prefix + (exports ? "_" + std::to_string(exports) : "") + ".csv";
+        std::string jsonPath = prefix + (exports ? "_" + std::to_string(exports) : "") + ".json";
+        ++exports;
+
+        FILE* csv = fopen(csvPath.c_str(), "w");
+        if (csv) {
+            fprintf(csv, "frame,input_us,update_us,render_us,present_us,frame_us\n");
+            for (const auto& t : frames) {
+                fprintf(csv, "%llu,%u,%u,%u,%u,%u\n", static_cast<unsigned long long>(t.frame),
+                        t.us[PHASE_INPUT], t.us[PHASE_UPDATE], t.us[PHASE_RENDER], t.us[PHASE_PRESENT], t.us[PHASE_FRAME]);
+            }
+            fclose(csv);
+        }
+
+        FILE* json = fopen(jsonPath.c_str(), "w");
+        if (json) {
+            fprintf(json, "{\n  \"frames\": %zu,\n  \"dropped\": %u,\n  \"phases\": {\n", frames.size(), dropped);
+            for (int p = 0; p < PHASE_COUNT; ++p) {
+                const HdrHistogram& h = histograms[p];
+                fprintf(json, "    \"%s\": { \"mean_us\": %.1f, \"p50_us\": %u, \"p95_us\": %u, \"p99_us\": %u, \"p999_us\": %u, \"max_us\": %u }%s\n",
+                        PHASE_NAMES[p], h.mean(), h.percentile(50), h.percentile(95), h.percentile(99), h.percentile(99.9), h.max(),
+                        p + 1 < PHASE_COUNT ? "," : "");
+            }
+            fprintf(json, "  },\n  \"hitches\": [");
+            for (size_t i = 0; i < hitches.size(); ++i) {
+                const FrameTiming& t = hitches[i];
+                fprintf(json, "%s\n    { \"frame\": %llu, \"input_us\": %u, \"update_us\": %u, \"render_us\": %u, \"present_us\": %u, \"frame_us\": %u }",
+                        i ? "," : "", static_cast<unsigned long long>(t.frame), t.us[PHASE_INPUT], t.us[PHASE_UPDATE],
+                        t.us[PHASE_RENDER], t.us[PHASE_PRESENT], t.us[PHASE_FRAME]);
+            }
+            fprintf(json, "%s]\n}\n", hitches.empty() ? "" : "\n  ");
+            fclose(json);
+        }
+        printf("Telemetria exportada a %s y %s\n", csvPath.c_str(), jsonPath.c_str());
+    }
+
+    std::string prefix;
+    bool exportOnFinish;
+    SpscRing<FrameTiming> ring;
+    Uint32 dropped;  // solo lo toca el hilo principal
+    SDL_sem* wake;
+    SDL_Thread* thread;
+    SDL_atomic_t quit;
+    SDL_atomic_t exportRequested;
+
+    // Solo los toca el hilo consumidor (y printSummary después de finish)
+    HdrHistogram histograms[PHASE_COUNT];
+    std::vector<FrameTiming> frames;
+    std::vector<FrameTiming> hitches;
+    int exports;
+    double averageFrameUs;
+};
+
+// Microsegundos entre dos lecturas de SDL_GetPerformanceCounter
+inline Uint32 elapsedUs(Uint64 from, Uint64 to) {
+    return static_cast<Uint32>((to - from) * 1000000 / SDL_GetPerformanceFrequency());
+}
+
+#endif
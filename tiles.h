@@ -0,0 +1,123 @@
+#ifndef BREAKOUT_TILES_H
+#define BREAKOUT_TILES_H
+
+#include "inc/SDL.h"
+#include "profiler.h"
+#include "render_commands.h"
+#include "workers.h"
+#include <algorithm>
+#include <vector>
+
+// Rasterizador por software dividido en tiles. Cada worker clasifica un rango
+// contiguo de comandos en sus propios bins por tile, y después cada tile se
+// rasteriza completo por un solo worker, así nadie escribe el mismo pixel y no
+// hacen falta locks sobre el framebuffer.
+class TileRenderer {
+public:
+    static const int TILE_SIZE = 64;
+
+    TileRenderer(int width, int height, WorkerPool& pool)
+        : width(width), height(height),
+          tilesX((width + TILE_SIZE - 1) / TILE_SIZE), tilesY((height + TILE_SIZE - 1) / TILE_SIZE),
+          pool(pool), framebuffer(static_cast<size_t>(width) * height),
+          bins(pool.size(), std::vector<std::vector<int>>(tilesX * tilesY)),
+          commands(nullptr), commandCount(0), clearColor(0) {
+        SDL_AtomicSet(&nextTile, 0);
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int pitch() const { return width * static_cast<int>(sizeof(Uint32)); }
+    const Uint32* pixels() const { return framebuffer.data(); }
+
+    // Dibuja los comandos en orden (el último queda encima) sobre el fondo clear
+    void render(const RenderCommand* cmds, int count, SDL_Color clear) {
+        commands = cmds;
+        commandCount = count;
+        clearColor = packColor(clear);
+        pool.run(binJob, this);
+        SDL_AtomicSet(&nextTile, 0);
+        pool.run(rasterJob, this);
+    }
+
+private:
+    static void binJob(void* data, int worker) {
+        PROFILE_ZONE("tiles.bin");
+        static_cast<TileRenderer*>(data)->bin(worker);
+    }
+
+    static void rasterJob(void* data, int worker) {
+        PROFILE_ZONE("tiles.raster");
+        TileRenderer* self = static_cast<TileRenderer*>(data);
+        const int tileCount = self->tilesX * self->tilesY;
+        for (;;) {
+            int tile = SDL_AtomicAdd(&self->nextTile, 1);
+            if (tile >= tileCount) break;
+            self->rasterTile(tile);
+        }
+        (void)worker;
+    }
+
+    void bin(int worker) {
+        std::vector<std::vector<int>>& mine = bins[worker];
+        for (auto& b : mine) b.clear();
+
+        const int workers = pool.size();
+        const int begin = static_cast<int>(static_cast<long long>(commandCount) * worker / workers);
+        const int end = static_cast<int>(static_cast<long long>(commandCount) * (worker + 1) / workers);
+
+        for (int i = begin; i < end; ++i) {
+            const SDL_Rect& r = commands[i].rect;
+            int x0 = std::max(r.x, 0);
+            int y0 = std::max(r.y, 0);
+            int x1 = std::min(r.x + r.w, width);
+            int y1 = std::min(r.y + r.h, height);
+            if (x0 >= x1 || y0 >= y1) continue;
+
+            for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ++ty) {
+                for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; ++tx) {
+                    mine[ty * tilesX + tx].push_back(i);
+                }
+            }
+        }
+    }
+
+    void rasterTile(int tile) {
+        const int tx0 = (tile % tilesX) * TILE_SIZE;
+        const int ty0 = (tile / tilesX) * TILE_SIZE;
+        const int tx1 = std::min(tx0 + TILE_SIZE, width);
+        const int ty1 = std::min(ty0 + TILE_SIZE, height);
+
+        for (int y = ty0; y < ty1; ++y) {
+            std::fill_n(&framebuffer[static_cast<size_t>(y) * width + tx0], tx1 - tx0, clearColor);
+        }
+
+        // Los bins de cada worker cubren rangos consecutivos, recorrerlos en
+        // orden de worker conserva el orden original de los comandos
+        for (const auto& workerBins : bins) {
+            for (int index : workerBins[tile]) {
+                const RenderCommand& cmd = commands[index];
+                int x0 = std::max(cmd.rect.x, tx0);
+                int y0 = std::max(cmd.rect.y, ty0);
+                int x1 = std::min(cmd.rect.x + cmd.rect.w, tx1);
+                int y1 = std::min(cmd.rect.y + cmd.rect.h, ty1);
+                Uint32 color = packColor(cmd.color);
+                for (int y = y0; y < y1; ++y) {
+                    std::fill_n(&framebuffer[static_cast<size_t>(y) * width + x0], x1 - x0, color);
+                }
+            }
+        }
+    }
+
+    int width, height;
+    int tilesX, tilesY;
+    WorkerPool& pool;
+    std::vector<Uint32> framebuffer;
+    std::vector<std::vector<std::vector<int>>> bins; // [worker][tile] -> índices de comandos
+    const RenderCommand* commands;
+    int commandCount;
+    Uint32 clearColor;
+    SDL_atomic_t nextTile;
+};
+
+#endif
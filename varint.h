@@ -0,0 +1,27 @@
+#ifndef BREAKOUT_VARINT_H
+#define BREAKOUT_VARINT_H
+
+#include "inc/SDL.h"
+#include <vector>
+
+// Enteros sin signo de largo variable: 7 bits por byte, el bit alto indica que sigue otro
+inline void appendVarint(std::vector<Uint8>& out, Uint64 value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<Uint8>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<Uint8>(value));
+}
+
+// Devuelve false si el buffer se termina antes que el número
+inline bool readVarint(const Uint8*& in, const Uint8* end, Uint64& value) {
+    value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7) {
+        Uint8 byte = *in++;
+        value |= static_cast<Uint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+#endif
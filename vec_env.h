@@ -0,0 +1,332 @@
+#ifndef BREAKOUT_VEC_ENV_H
+#define BREAKOUT_VEC_ENV_H
+
+#include "inc/SDL.h"
+#include "breakout.h"
+#include "workers.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Acciones de un agente: los mismos botones que applyInput()
+enum { ACTION_NONE = 0, ACTION_LEFT = INPUT_LEFT, ACTION_RIGHT = INPUT_RIGHT };
+
+const int ENV_BLOCKS = BLOCK_ROWS * BLOCK_COLUMNS;
+static_assert(ENV_BLOCKS <= 64, "los bloques de un entorno van en una máscara de 64 bits");
+
+// Observación por entorno: paddle x, pelota x, y, vx, vy (normalizados por la
+// pantalla y BALL_SPEED) y 1/0 por bloque activo
+const int OBS_PADDLE_X = 0, OBS_BALL_X = 1, OBS_BALL_Y = 2, OBS_BALL_VX = 3, OBS_BALL_VY = 4, OBS_BLOCKS = 5;
+const int OBS_SIZE = OBS_BLOCKS + ENV_BLOCKS;
+
+// Recompensas: una por bloque roto, castigo al perder la pelota
+const float REWARD_BLOCK = 1.0f;
+const float REWARD_GAME_OVER = -1.0f;
+
+// N partidas de una pantalla que avanzan juntas con step(actions). Cada campo
+// es un arreglo con un valor por entorno (SoA), así el movimiento del paddle,
+// la pelota y los rebotes en las paredes van de a 4 entornos con SSE2. Las
+// colisiones con el paddle y los bloques siguen las mismas reglas que update()
+// (el mismo orden y las mismas comparaciones en float) pero en vez de la
+// grilla calculan la fila y columna candidatas, porque el nivel es el mismo en
+// todos los entornos. Las observaciones, recompensas y fines de partida se
+// escriben en buffers propios que el llamador lee sin copiar; al terminar una
+// partida el entorno se reinicia solo y devuelve la observación inicial.
+class VectorEnv {
+public:
+    VectorEnv(int count, WorkerPool* pool = nullptr)
+        : count(count), pool(pool), paddleX(count), ballX(count), ballY(count), ballVx(count), ballVy(count),
+          paddleVx(count), blockMask(count), blocksLeft(count), score(count), episodes(count, 0),
+          obs(static_cast<size_t>(count) * OBS_SIZE), rewards(count), dones(count), stepActions(nullptr), dT(1.0f / MAX_FPS) {
+        for (int j = 0; j < BLOCK_COLUMNS; ++j) blockX[j] = j * (BLOCK_WIDTH + 10) + 35.0f;
+        for (int i = 0; i < BLOCK_ROWS; ++i) blockY[i] = i * (BLOCK_HEIGHT + 10) + 30.0f;
+        paddleY = SCREEN_HEIGHT - PADDLE_HEIGHT - 10.0f;
+        for (int e = 0; e < count; ++e) reset(e);
+    }
+
+    int size() const { return count; }
+
+    // Una acción por entorno; avanza todos un tick de dT segundos
+    void step(const Uint8* actions, float stepDt = 1.0f / MAX_FPS) {
+        stepActions = actions;
+        dT = stepDt;
+        if (pool && pool->size() > 1) {
+            pool->run(stepJob, this);
+        } else {
+            stepRange(0, count);
+        }
+    }
+
+    void reset(int e) {
+        paddleX[e] = (SCREEN_WIDTH - PADDLE_WIDTH) / 2.0f;
+        paddleVx[e] = 0.0f;
+        ballX[e] = SCREEN_WIDTH / 2.0f;
+        ballY[e] = SCREEN_HEIGHT / 2.0f;
+        ballVx[e] = BALL_SPEED;
+        ballVy[e] = BALL_SPEED;
+        blockMask[e] = ENV_BLOCKS == 64 ? ~0ull : (1ull << ENV_BLOCKS) - 1;
+        blocksLeft[e] = ENV_BLOCKS;
+        score[e] = 0;
+        float* o = &obs[static_cast<size_t>(e) * OBS_SIZE];
+        for (int b = 0; b < ENV_BLOCKS; ++b) o[OBS_BLOCKS + b] = 1.0f;
+        writeObservation(e);
+    }
+
+    // Buffers de salida: N * OBS_SIZE floats, N recompensas y N fines de partida
+    const float* observations() const { return obs.data(); }
+    const float* getRewards() const { return rewards.data(); }
+    const Uint8* getDones() const { return dones.data(); }
+
+    // Estado del entorno e, para comparar contra el ECS
+    float getPaddleX(int e) const { return paddleX[e]; }
+    float getBallX(int e) const { return ballX[e]; }
+    float getBallY(int e) const { return ballY[e]; }
+    float getBallVx(int e) const { return ballVx[e]; }
+    float getBallVy(int e) const { return ballVy[e]; }
+    Uint64 getBlockMask(int e) const { return blockMask[e]; }
+    int getScore(int e) const { return score[e]; }
+    Uint64 getEpisodes(int e) const { return episodes[e]; }
+
+private:
+    static void stepJob(void* data, int worker) {
+        VectorEnv& env = *static_cast<VectorEnv*>(data);
+        // Tramos múltiplos de 4 para que SSE2 no parta un grupo entre workers
+        int workers = env.pool->size();
+        int chunk = ((env.count + workers - 1) / workers + 3) & ~3;
+        int begin = worker * chunk;
+        int end = begin + chunk < env.count ? begin + chunk : env.count;
+        if (begin < end) env.stepRange(begin, end);
+    }
+
+    void stepRange(int begin, int end) {
+        move(begin, end);
+        for (int e = begin; e < end; ++e) collide(e);
+    }
+
+    // Paddle y pelota de todos los entornos del tramo, con los rebotes en las
+    // paredes de update(): si la pelota se sale por los costados se invierte
+    // vx, si se sale por arriba vy
+    void move(int begin, int end) {
+        int e = begin;
+#if defined(__SSE2__)
+        const __m128 vdt = _mm_set1_ps(dT);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 paddleMax = _mm_set1_ps(static_cast<float>(SCREEN_WIDTH - PADDLE_WIDTH));
+        const __m128 paddleW = _mm_set1_ps(static_cast<float>(PADDLE_WIDTH));
+        const __m128 ballSize = _mm_set1_ps(static_cast<float>(BALL_SIZE));
+        const __m128 screenW = _mm_set1_ps(static_cast<float>(SCREEN_WIDTH));
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        for (; e + 4 <= end; e += 4) {
+            for (int k = 0; k < 4; ++k) paddleVx[e + k] = actionVelocity(stepActions[e + k]);
+            __m128 px = _mm_add_ps(_mm_loadu_ps(&paddleX[e]), _mm_mul_ps(_mm_loadu_ps(&paddleVx[e]), vdt));
+            px = select(_mm_cmplt_ps(px, zero), zero, px);
+            px = select(_mm_cmpgt_ps(_mm_add_ps(px, paddleW), screenW), paddleMax, px);
+            _mm_storeu_ps(&paddleX[e], px);
+
+            __m128 vx = _mm_loadu_ps(&ballVx[e]);
+            __m128 vy = _mm_loadu_ps(&ballVy[e]);
+            __m128 bx = _mm_add_ps(_mm_loadu_ps(&ballX[e]), _mm_mul_ps(vx, vdt));
+            __m128 by = _mm_add_ps(_mm_loadu_ps(&ballY[e]), _mm_mul_ps(vy, vdt));
+            __m128 sideHit = _mm_or_ps(_mm_cmplt_ps(bx, zero), _mm_cmpgt_ps(_mm_add_ps(bx, ballSize), screenW));
+            __m128 topHit = _mm_cmplt_ps(by, zero);
+            _mm_storeu_ps(&ballX[e], bx);
+            _mm_storeu_ps(&ballY[e], by);
+            _mm_storeu_ps(&ballVx[e], _mm_xor_ps(vx, _mm_and_ps(sideHit, sign)));
+            _mm_storeu_ps(&ballVy[e], _mm_xor_ps(vy, _mm_and_ps(topHit, sign)));
+        }
+#endif
+        for (; e < end; ++e) {
+            paddleVx[e] = actionVelocity(stepActions[e]);
+            float px = paddleX[e] + paddleVx[e] * dT;
+            if (px < 0) px = 0;
+            if (px + PADDLE_WIDTH > SCREEN_WIDTH) px = SCREEN_WIDTH - PADDLE_WIDTH;
+            paddleX[e] = px;
+
+            ballX[e] += ballVx[e] * dT;
+            ballY[e] += ballVy[e] * dT;
+            if (ballX[e] < 0 || ballX[e] + BALL_SIZE > SCREEN_WIDTH) ballVx[e] *= -1;
+            if (ballY[e] < 0) ballVy[e] *= -1;
+        }
+    }
+
+    // Lo que sigue de update() para un entorno: fondo, paddle, bloques y fin
+    void collide(int e) {
+        float reward = 0.0f;
+        bool done = false;
+        float& x = ballX[e];
+        float& y = ballY[e];
+        float& vy = ballVy[e];
+
+        if (y + BALL_SIZE > SCREEN_HEIGHT) {
+            reward = REWARD_GAME_OVER;
+            done = true;
+        } else {
+            if (x < paddleX[e] + PADDLE_WIDTH && x + BALL_SIZE > paddleX[e] && y < paddleY + PADDLE_HEIGHT && y + BALL_SIZE > paddleY) {
+                vy *= -1;
+                y = paddleY - BALL_SIZE;
+            }
+
+            // Filas y columnas que puede tocar la pelota (a lo sumo dos de cada una)
+            const float rowPitch = BLOCK_HEIGHT + 10.0f, columnPitch = BLOCK_WIDTH + 10.0f;
+            int i0 = static_cast<int>(std::floor((y - blockY[0] - BLOCK_HEIGHT) / rowPitch));
+            int j0 = static_cast<int>(std::floor((x - blockX[0] - BLOCK_WIDTH) / columnPitch));
+            if (i0 < BLOCK_ROWS && j0 < BLOCK_COLUMNS) {
+                float* o = &obs[static_cast<size_t>(e) * OBS_SIZE + OBS_BLOCKS];
+                for (int i = i0 < 0 ? 0 : i0; i <= i0 + 2 && i < BLOCK_ROWS; ++i) {
+                    for (int j = j0 < 0 ? 0 : j0; j <= j0 + 2 && j < BLOCK_COLUMNS; ++j) {
+                        int b = i * BLOCK_COLUMNS + j;
+                        if ((blockMask[e] >> b & 1) && x < blockX[j] + BLOCK_WIDTH && x + BALL_SIZE > blockX[j] &&
+                            y < blockY[i] + BLOCK_HEIGHT && y + BALL_SIZE > blockY[i]) {
+                            vy *= -1;
+                            blockMask[e] &= ~(1ull << b);
+                            --blocksLeft[e];
+                            score[e] += 10;
+                            reward += REWARD_BLOCK;
+                            o[b] = 0.0f;
+                        }
+                    }
+                }
+            }
+            done = blocksLeft[e] == 0;
+        }
+
+        rewards[e] = reward;
+        dones[e] = done;
+        if (done) {
+            ++episodes[e];
+            reset(e);
+        } else {
+            writeObservation(e);
+        }
+    }
+
+    void writeObservation(int e) {
+        float* o = &obs[static_cast<size_t>(e) * OBS_SIZE];
+        o[OBS_PADDLE_X] = paddleX[e] / SCREEN_WIDTH;
+        o[OBS_BALL_X] = ballX[e] / SCREEN_WIDTH;
+        o[OBS_BALL_Y] = ballY[e] / SCREEN_HEIGHT;
+        o[OBS_BALL_VX] = ballVx[e] / BALL_SPEED;
+        o[OBS_BALL_VY] = ballVy[e] / BALL_SPEED;
+    }
+
+    // Como applyInput(): derecha gana si están los dos botones
+    static float actionVelocity(Uint8 action) {
+        if (action & ACTION_RIGHT) return PADDLE_SPEED;
+        if (action & ACTION_LEFT) return -PADDLE_SPEED;
+        return 0.0f;
+    }
+
+#if defined(__SSE2__)
+    static __m128 select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+#endif
+
+    int count;
+    WorkerPool* pool;
+    std::vector<float> paddleX, ballX, ballY, ballVx, ballVy, paddleVx;
+    std::vector<Uint64> blockMask;
+    std::vector<int> blocksLeft, score;
+    std::vector<Uint64> episodes;
+    std::vector<float> obs;
+    std::vector<float> rewards;
+    std::vector<Uint8> dones;
+    float blockX[BLOCK_COLUMNS], blockY[BLOCK_ROWS];
+    float paddleY;
+    const Uint8* stepActions; // los del step() en curso
+    float dT;
+};
+
+// Corro los entornos y, al lado, un ECS de una pantalla por entorno con
+// applyInput() y update(), y comparo paddle, pelota, bloques, puntaje y fin
+// de partida en cada paso. Las reglas de VectorEnv están copiadas de update():
+// si se cambia una y no la otra, esto falla en el primer paso distinto.
+// Devuelve 0 si coinciden en todos los pasos.
+inline int checkVectorEnv(int envs, int steps) {
+    VectorEnv env(envs);
+    std::vector<ECS> worlds(envs);
+    for (ECS& w : worlds) initializeEntities(w, 1);
+    std::vector<Uint8> actions(envs);
+    Uint32 rng = 0x9E3779B9u;
+    Uint64 episodes = 0, cleared = 0;
+    const float rowPitch = BLOCK_HEIGHT + 10.0f, columnPitch = BLOCK_WIDTH + 10.0f;
+
+    for (int s = 0; s < steps; ++s) {
+        // La mitad con el piloto automático, para llegar a los últimos
+        // bloques; la otra al azar, también con los dos botones juntos
+        for (int e = 0; e < envs; ++e) {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            actions[e] = static_cast<Uint8>(e % 2 ? rng % 4 : autopilotInput(worlds[e]));
+        }
+        env.step(actions.data());
+        for (int e = 0; e < envs; ++e) {
+            ECS& w = worlds[e];
+            applyInput(w, actions[e]);
+            const bool done = update(w, 1.0f / MAX_FPS) != GameStatus::Running;
+            const char* field = nullptr;
+            if (done != (env.getDones()[e] != 0)) field = "fin de partida";
+            if (!field && done) {
+                ++episodes;
+                if (w.blocksLeft == 0) ++cleared;
+                w = ECS();
+                initializeEntities(w, 1);
+                continue;
+            }
+            const Position& paddle = w.positions[w.paddles.begin()->first];
+            const Position& ball = w.positions[w.balls.begin()->first];
+            const Velocity& v = w.velocities[w.balls.begin()->first];
+            if (!field && paddle.x != env.getPaddleX(e)) field = "paddle x";
+            if (!field && (ball.x != env.getBallX(e) || ball.y != env.getBallY(e))) field = "posicion de la pelota";
+            if (!field && (v.vx != env.getBallVx(e) || v.vy != env.getBallVy(e))) field = "velocidad de la pelota";
+            if (!field && w.score != env.getScore(e)) field = "puntaje";
+            if (!field) {
+                for (const auto& b : w.blocks) {
+                    const Position& p = w.positions[b.first];
+                    int i = static_cast<int>(std::lround((p.y - 30.0f) / rowPitch));
+                    int j = static_cast<int>(std::lround((p.x - 35.0f) / columnPitch));
+                    if (b.second.active != ((env.getBlockMask(e) >> (i * BLOCK_COLUMNS + j) & 1) != 0)) field = "bloques";
+                }
+            }
+            if (field) {
+                printf("VectorEnv difiere de update() en el paso %d, entorno %d: %s\n", s, e, field);
+                return 1;
+            }
+        }
+    }
+    printf("VectorEnv igual a update() en %d entornos x %d pasos (%llu partidas terminadas, %llu sin bloques)\n", envs, steps,
+           static_cast<unsigned long long>(episodes), static_cast<unsigned long long>(cleared));
+    return 0;
+}
+
+// Entornos por segundo con acciones al azar
+inline int benchVectorEnv(int envs, int steps, int threads) {
+    WorkerPool pool(threads);
+    VectorEnv env(envs, &pool);
+    std::vector<Uint8> actions(envs);
+    Uint32 rng = 0x9E3779B9u;
+    Uint64 episodes = 0;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int s = 0; s < steps; ++s) {
+        for (auto& a : actions) {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            a = static_cast<Uint8>(rng % 3);
+        }
+        env.step(actions.data());
+        const Uint8* dones = env.getDones();
+        for (int e = 0; e < envs; ++e) episodes += dones[e];
+    }
+    double seconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+    printf("%d entornos x %d pasos con %d hilos: %.3f s, %.0f pasos de entorno/s, %llu partidas terminadas\n", envs, steps,
+           pool.size(), seconds, envs * static_cast<double>(steps) / seconds, static_cast<unsigned long long>(episodes));
+    return 0;
+}
+
+#endif
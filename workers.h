@@ -0,0 +1,75 @@
+#ifndef BREAKOUT_WORKERS_H
+#define BREAKOUT_WORKERS_H
+
+#include "inc/SDL.h"
+#include <vector>
+
+// Pool de hilos sobre SDL_Thread. El hilo que llama a run() trabaja como worker 0,
+// cada worker tiene su propio semáforo de arranque para que nunca ejecute dos veces
+// el mismo trabajo y el índice de worker sea estable dentro de un run().
+class WorkerPool {
+public:
+    typedef void (*Job)(void* data, int worker);
+
+    explicit WorkerPool(int threads) : job(nullptr), data(nullptr), quit(false) {
+        if (threads < 1) threads = 1;
+        done = SDL_CreateSemaphore(0);
+        workers.resize(threads - 1);
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].pool = this;
+            workers[i].index = static_cast<int>(i) + 1;
+            workers[i].start = SDL_CreateSemaphore(0);
+            workers[i].thread = SDL_CreateThread(workerMain, "worker", &workers[i]);
+        }
+    }
+
+    ~WorkerPool() {
+        quit = true;
+        for (auto& w : workers) SDL_SemPost(w.start);
+        for (auto& w : workers) {
+            SDL_WaitThread(w.thread, NULL);
+            SDL_DestroySemaphore(w.start);
+        }
+        SDL_DestroySemaphore(done);
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Ejecuta job(data, worker) en todos los workers y espera a que terminen
+    void run(Job j, void* d) {
+        job = j;
+        data = d;
+        for (auto& w : workers) SDL_SemPost(w.start);
+        job(data, 0);
+        for (size_t i = 0; i < workers.size(); ++i) SDL_SemWait(done);
+    }
+
+private:
+    struct Worker {
+        WorkerPool* pool;
+        int index;
+        SDL_sem* start;
+        SDL_Thread* thread;
+    };
+
+    static int SDLCALL workerMain(void* arg) {
+        Worker* w = static_cast<Worker*>(arg);
+        for (;;) {
+            SDL_SemWait(w->start);
+            if (w->pool->quit) return 0;
+            w->pool->job(w->pool->data, w->index);
+            SDL_SemPost(w->pool->done);
+        }
+    }
+
+    std::vector<Worker> workers;
+    SDL_sem* done;
+    Job job;
+    void* data;
+    volatile bool quit;
+};
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef BREAKOUT_WORLD_SNAPSHOT_H
+#define BREAKOUT_WORLD_SNAPSHOT_H
+
+#include "inc/SDL.h"
+#include "breakout.h"
+#include <cstring>
+#include <vector>
+
+// Foto del mundo entero en un solo bloque de memoria, para guardar partidas,
+// volver atrás (rollback), probar jugadas y reiniciar niveles rápido. Es una
+// cabecera con una tabla de secciones y, después, los arreglos de cada
+// ComponentMap (pares densos e índice), la grilla de bloques aplanada y los
+// eventos, cada uno alineado a 8 bytes. Todo se ubica por offset desde el
+// inicio, así el bloque se puede copiar o mover a cualquier lado. Restaurar
+// es un memcpy por sección y un paso que vuelve a armar las celdas de la
+// grilla; sobre un mundo que ya tiene la capacidad no asigna memoria.
+//
+// A diferencia de world_state.h, el formato es el de la memoria de este
+// binario (tamaños, alineación, endianness): sirve dentro del proceso o entre
+// copias del mismo ejecutable, no para archivos portables.
+const Uint32 WORLD_SNAPSHOT_MAGIC = 0x534B5242; // "BRKS"
+const Uint32 WORLD_SNAPSHOT_VERSION = 1;
+
+// Dos por componente (pares e índice), tres de la grilla (inicios, ids, marcas) y los eventos
+const int SNAPSHOT_SECTIONS = 2 * 8 + 3 + 1;
+
+struct SnapshotSection {
+    Uint64 offset; // desde el inicio del bloque
+    Uint64 count;  // elementos
+};
+
+struct SnapshotHeader {
+    Uint32 magic;
+    Uint32 version;
+    Uint64 bytes; // tamaño del bloque entero
+    Sint32 nextEntity, worldHeight, blocksLeft, score;
+    SpatialGrid::Layout grid;
+    SnapshotSection sections[SNAPSHOT_SECTIONS];
+};
+
+// Escribe las secciones una detrás de otra; con out nulo solo mide
+class SnapshotWriter {
+public:
+    SnapshotWriter(Uint8* out, SnapshotHeader& header) : out(out), header(header), offset(sizeof(SnapshotHeader)), section(0) {}
+
+    // Devuelve dónde va la sección (nulo si solo se mide); si data no es nulo la copia
+    Uint8* add(const void* data, size_t count, size_t elementSize) {
+        offset = (offset + 7) & ~static_cast<size_t>(7);
+        header.sections[section++] = { offset, count };
+        Uint8* dst = out ? out + offset : nullptr;
+        if (dst && data && count) memcpy(dst, data, count * elementSize);
+        offset += count * elementSize;
+        return dst;
+    }
+
+    template <typename T>
+    void addMap(const ComponentMap<T>& map) {
+        add(map.data(), map.size(), sizeof(typename ComponentMap<T>::value_type));
+        add(map.indexData(), map.indexSize(), sizeof(int));
+    }
+
+    size_t size() const { return offset; }
+
+private:
+    Uint8* out;
+    SnapshotHeader& header;
+    size_t offset;
+    int section;
+};
+
+// Mido (out nulo) o escribo la foto; devuelve el tamaño en bytes
+inline size_t writeWorldSnapshot(const ECS& ecs, Uint8* out) {
+    SnapshotHeader header = {};
+    SnapshotWriter w(out, header);
+    w.addMap(ecs.positions);
+    w.addMap(ecs.velocities);
+    w.addMap(ecs.colors);
+    w.addMap(ecs.sprites);
+    w.addMap(ecs.paddles);
+    w.addMap(ecs.balls);
+    w.addMap(ecs.blocks);
+    w.addMap(ecs.cameras);
+
+    const SpatialGrid& grid = ecs.blockGrid;
+    const size_t cells = grid.cellCount();
+    Uint8* starts = w.add(nullptr, cells + 1, sizeof(Uint32));
+    Uint32 total = 0;
+    for (size_t i = 0; i < cells; ++i) {
+        if (starts) memcpy(starts + i * sizeof(Uint32), &total, sizeof(Uint32));
+        total += static_cast<Uint32>(grid.cell(i).size());
+    }
+    if (starts) memcpy(starts + cells * sizeof(Uint32), &total, sizeof(Uint32));
+    Uint8* ids = w.add(nullptr, total, sizeof(int));
+    if (ids) {
+        for (size_t i = 0; i < cells; ++i) {
+            const std::vector<int>& cell = grid.cell(i);
+            if (cell.empty()) continue;
+            memcpy(ids, cell.data(), cell.size() * sizeof(int));
+            ids += cell.size() * sizeof(int);
+        }
+    }
+    w.add(grid.queryStamps().data(), grid.queryStamps().size(), sizeof(Uint32));
+    w.add(ecs.events.data(), ecs.events.size(), sizeof(BreakEvent));
+
+    if (out) {
+        header.magic = WORLD_SNAPSHOT_MAGIC;
+        header.version = WORLD_SNAPSHOT_VERSION;
+        header.bytes = w.size();
+        header.nextEntity = ecs.nextEntity;
+        header.worldHeight = ecs.worldHeight;
+        header.blocksLeft = ecs.blocksLeft;
+        header.score = ecs.score;
+        header.grid = grid.layout();
+        memcpy(out, &header, sizeof(header));
+    }
+    return w.size();
+}
+
+// Lee las secciones en el mismo orden en que se escribieron; solo ubica
+// punteros y cantidades, no toca el mundo
+class SnapshotReader {
+public:
+    SnapshotReader(const Uint8* data, size_t size, const SnapshotHeader& header)
+        : data(data), size(size), header(header), section(0), failed(false) {}
+
+    const void* next(size_t elementSize, size_t& count) {
+        const SnapshotSection& s = header.sections[section++];
+        count = static_cast<size_t>(s.count);
+        if (s.offset > size || s.count > (size - s.offset) / elementSize) {
+            failed = true;
+            count = 0;
+            return nullptr;
+        }
+        return data + s.offset;
+    }
+
+    bool ok() const { return !failed; }
+
+private:
+    const Uint8* data;
+    size_t size;
+    const SnapshotHeader& header;
+    int section;
+    bool failed;
+};
+
+// Pares e índice de un ComponentMap dentro de la foto
+template <typename T>
+struct SnapshotMap {
+    typedef typename ComponentMap<T>::value_type Pair;
+    const Pair* items = nullptr;
+    const int* index = nullptr;
+    size_t count = 0, indexCount = 0;
+
+    void read(SnapshotReader& in) {
+        items = static_cast<const Pair*>(in.next(sizeof(Pair), count));
+        index = static_cast<const int*>(in.next(sizeof(int), indexCount));
+    }
+
+    void assign(ComponentMap<T>& map) const { map.assignRaw(items, count, index, indexCount); }
+};
+
+// Restauro el mundo desde una foto alineada a 8 bytes. Primero se ubican y
+// verifican todas las secciones (tamaños y la grilla: los inicios de cada
+// celda no bajan y no se pasan de los ids) y recién después se copia, así una
+// foto cortada o rota devuelve false sin tocar el mundo. Del contenido de los
+// componentes solo se verifican los jugadores de los paddles, que usan
+// applyInput() y findPaddle() como índices; el resto tiene que venir de
+// writeWorldSnapshot() de este mismo binario.
+inline bool restoreWorldSnapshot(const void* snapshot, size_t size, ECS& ecs) {
+    SnapshotHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, snapshot, sizeof(header));
+    if (header.magic != WORLD_SNAPSHOT_MAGIC || header.version != WORLD_SNAPSHOT_VERSION || header.bytes != size) return false;
+
+    SnapshotReader in(static_cast<const Uint8*>(snapshot), size, header);
+    SnapshotMap<Position> positions;
+    SnapshotMap<Velocity> velocities;
+    SnapshotMap<Color> colors;
+    SnapshotMap<Sprite> sprites;
+    SnapshotMap<Paddle> paddles;
+    SnapshotMap<Ball> balls;
+    SnapshotMap<Block> blocks;
+    SnapshotMap<Camera> cameras;
+    positions.read(in);
+    velocities.read(in);
+    colors.read(in);
+    sprites.read(in);
+    paddles.read(in);
+    balls.read(in);
+    blocks.read(in);
+    cameras.read(in);
+
+    size_t startCount, idCount, stampCount, eventCount;
+    const Uint32* starts = static_cast<const Uint32*>(in.next(sizeof(Uint32), startCount));
+    const int* ids = static_cast<const int*>(in.next(sizeof(int), idCount));
+    const Uint32* stamps = static_cast<const Uint32*>(in.next(sizeof(Uint32), stampCount));
+    const BreakEvent* events = static_cast<const BreakEvent*>(in.next(sizeof(BreakEvent), eventCount));
+    const SpatialGrid::Layout& grid = header.grid;
+    if (!in.ok() || grid.cellSize <= 0 || grid.columns < 0 || grid.rows < 0 ||
+        startCount != static_cast<size_t>(grid.columns) * static_cast<size_t>(grid.rows) + 1) {
+        return false;
+    }
+    // SpatialGrid::restore() copia ids[starts[i], starts[i + 1]) por celda
+    if (starts[0] != 0 || starts[startCount - 1] != idCount) return false;
+    for (size_t i = 1; i < startCount; ++i) {
+        if (starts[i] < starts[i - 1]) return false;
+    }
+    if (!validPaddlePlayers(paddles.items, paddles.items + paddles.count)) return false;
+
+    positions.assign(ecs.positions);
+    velocities.assign(ecs.velocities);
+    colors.assign(ecs.colors);
+    sprites.assign(ecs.sprites);
+    paddles.assign(ecs.paddles);
+    balls.assign(ecs.balls);
+    blocks.assign(ecs.blocks);
+    cameras.assign(ecs.cameras);
+    ecs.blockGrid.restore(grid, starts, ids, stamps, stampCount);
+    ecs.events.assign(events, events + eventCount);
+
+    ecs.nextEntity = header.nextEntity;
+    ecs.worldHeight = header.worldHeight;
+    ecs.blocksLeft = header.blocksLeft;
+    ecs.score = header.score;
+    reserveScratch(ecs);
+    return true;
+}
+
+// Foto guardada en memoria propia; se puede reutilizar para no asignar en cada save()
+class WorldSnapshot {
+public:
+    void save(const ECS& ecs) {
+        bytes = writeWorldSnapshot(ecs, nullptr);
+        storage.resize((bytes + 7) / 8);
+        writeWorldSnapshot(ecs, reinterpret_cast<Uint8*>(storage.data()));
+    }
+
+    bool restore(ECS& ecs) const { return bytes != 0 && restoreWorldSnapshot(storage.data(), bytes, ecs); }
+
+    const void* data() const { return storage.data(); }
+    size_t size() const { return bytes; }
+
+private:
+    std::vector<Uint64> storage; // Uint64 para que el bloque quede alineado a 8
+    size_t bytes = 0;
+};
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef BREAKOUT_WORLD_STATE_H
+#define BREAKOUT_WORLD_STATE_H
+
+#include "inc/SDL.h"
+#include "breakout.h"
+#include "render_commands.h"
+#include <cstring>
+#include <vector>
+
+// El mundo como una lista de palabras de 32 bits, campo por campo y sin bytes
+// de relleno: primero los contadores del ECS y después cada componente como
+// cantidad y, por elemento, (id, campos...). Dos mundos iguales dan las mismas
+// palabras, así se pueden comparar, hacer XOR entre ticks o calcular un hash.
+// La grilla de bloques no se guarda: se rearma con los bloques activos.
+const Uint32 WORLD_STATE_VERSION = 2; // 2: paddles con jugador y tantos
+
+// Límites al leer, para que un archivo roto o ajeno no pida gigas de memoria
+const int MAX_PACKED_ENTITIES = 1 << 24;
+const int MAX_PACKED_HEIGHT = SCREEN_HEIGHT * 4096;
+
+inline Uint32 floatBits(float value) {
+    Uint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float bitsFloat(Uint32 bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Inversa de packColor() de render_commands.h
+inline SDL_Color unpackColor(Uint32 v) {
+    return { static_cast<Uint8>(v >> 16), static_cast<Uint8>(v >> 8), static_cast<Uint8>(v), static_cast<Uint8>(v >> 24) };
+}
+
+// Cómo quedan las palabras, para decir a qué entidad y campo corresponde cada
+// una (state_hash.h). Hay que mantenerlo igual que packWorld().
+const int WORLD_HEADER_WORDS = 5;
+const char* const WORLD_HEADER_FIELDS[WORLD_HEADER_WORDS] = { "version", "nextEntity", "worldHeight", "blocksLeft", "score" };
+
+struct PackedComponent {
+    const char* name;
+    int fields;               // palabras por elemento, sin contar el id
+    const char* fieldNames[4];
+    char types[4];            // 'f' float, 'i' entero, 'c' color
+};
+
+const PackedComponent WORLD_STATE_COMPONENTS[] = {
+    { "Position", 2, { "x", "y" }, { 'f', 'f' } },
+    { "Velocity", 2, { "vx", "vy" }, { 'f', 'f' } },
+    { "Color", 1, { "color" }, { 'c' } },
+    { "Sprite", 1, { "id" }, { 'i' } },
+    { "Paddle", 2, { "player", "points" }, { 'i', 'i' } },
+    { "Ball", 0, {}, {} },
+    { "Block", 1, { "active" }, { 'i' } },
+    { "Camera", 4, { "x", "y", "w", "h" }, { 'f', 'f', 'i', 'i' } },
+};
+
+inline void packWorld(const ECS& ecs, std::vector<Uint32>& out) {
+    out.clear();
+    out.push_back(WORLD_STATE_VERSION);
+    out.push_back(static_cast<Uint32>(ecs.nextEntity));
+    out.push_back(static_cast<Uint32>(ecs.worldHeight));
+    out.push_back(static_cast<Uint32>(ecs.blocksLeft));
+    out.push_back(static_cast<Uint32>(ecs.score));
+
+    out.push_back(static_cast<Uint32>(ecs.positions.size()));
+    for (const auto& p : ecs.positions) {
+        out.push_back(p.first);
+        out.push_back(floatBits(p.second.x));
+        out.push_back(floatBits(p.second.y));
+    }
+    out.push_back(static_cast<Uint32>(ecs.velocities.size()));
+    for (const auto& v : ecs.velocities) {
+        out.push_back(v.first);
+        out.push_back(floatBits(v.second.vx));
+        out.push_back(floatBits(v.second.vy));
+    }
+    out.push_back(static_cast<Uint32>(ecs.colors.size()));
+    for (const auto& c : ecs.colors) {
+        out.push_back(c.first);
+        out.push_back(packColor(c.second.color));
+    }
+    out.push_back(static_cast<Uint32>(ecs.sprites.size()));
+    for (const auto& s : ecs.sprites) {
+        out.push_back(s.first);
+        out.push_back(s.second.id);
+    }
+    out.push_back(static_cast<Uint32>(ecs.paddles.size()));
+    for (const auto& p : ecs.paddles) {
+        out.push_back(p.first);
+        out.push_back(static_cast<Uint32>(p.second.player));
+        out.push_back(static_cast<Uint32>(p.second.points));
+    }
+    out.push_back(static_cast<Uint32>(ecs.balls.size()));
+    for (const auto& b : ecs.balls) out.push_back(b.first);
+    out.push_back(static_cast<Uint32>(ecs.blocks.size()));
+    for (const auto& b : ecs.blocks) {
+        out.push_back(b.first);
+        out.push_back(b.second.active ? 1 : 0);
+    }
+    out.push_back(static_cast<Uint32>(ecs.cameras.size()));
+    for (const auto& c : ecs.cameras) {
+        out.push_back(c.first);
+        out.push_back(floatBits(c.second.x));
+        out.push_back(floatBits(c.second.y));
+        out.push_back(static_cast<Uint32>(c.second.w));
+        out.push_back(static_cast<Uint32>(c.second.h));
+    }
+}
+
+// Lector de palabras que no se pasa del final
+class WordReader {
+public:
+    WordReader(const Uint32* words, size_t count) : p(words), end(words + count), failed(false) {}
+
+    Uint32 next() {
+        if (p >= end) {
+            failed = true;
+            return 0;
+        }
+        return *p++;
+    }
+
+    // Id de entidad; tiene que ser menor que nextEntity, así operator[] de
+    // ComponentMap no agranda el índice con un valor cualquiera
+    int entity(int nextEntity) {
+        Uint32 id = next();
+        if (id >= static_cast<Uint32>(nextEntity)) failed = true;
+        return failed ? 0 : static_cast<int>(id);
+    }
+
+    // Cantidad de elementos de un componente, si entran en lo que queda
+    Uint32 count(size_t wordsPerItem) {
+        Uint32 n = next();
+        if (static_cast<size_t>(end - p) < n * wordsPerItem) failed = true;
+        return failed ? 0 : n;
+    }
+
+    bool ok() const { return !failed; }
+
+private:
+    const Uint32* p;
+    const Uint32* end;
+    bool failed;
+};
+
+// Rearmo el mundo desde sus palabras; false si no son de esta versión, están
+// cortadas o tienen ids, tamaños o jugadores fuera de rango
+inline bool unpackWorld(const Uint32* words, size_t count, ECS& ecs) {
+    WordReader in(words, count);
+    if (in.next() != WORLD_STATE_VERSION) return false;
+    ecs = ECS();
+    ecs.nextEntity = static_cast<int>(in.next());
+    ecs.worldHeight = static_cast<int>(in.next());
+    ecs.blocksLeft = static_cast<int>(in.next());
+    ecs.score = static_cast<int>(in.next());
+    if (!in.ok() || ecs.nextEntity < 0 || ecs.nextEntity > MAX_PACKED_ENTITIES || ecs.worldHeight <= 0 ||
+        ecs.worldHeight > MAX_PACKED_HEIGHT) {
+        return false;
+    }
+    const int limit = ecs.nextEntity;
+
+    Uint32 n = in.count(3);
+    ecs.positions.reserve(n);
+    for (Uint32 i = 0; i < n; ++i) {
+        Position& p = ecs.positions[in.entity(limit)];
+        p.x = bitsFloat(in.next());
+        p.y = bitsFloat(in.next());
+    }
+    n = in.count(3);
+    for (Uint32 i = 0; i < n; ++i) {
+        Velocity& v = ecs.velocities[in.entity(limit)];
+        v.vx = bitsFloat(in.next());
+        v.vy = bitsFloat(in.next());
+    }
+    n = in.count(2);
+    ecs.colors.reserve(n);
+    for (Uint32 i = 0; i < n; ++i) {
+        int id = in.entity(limit);
+        ecs.colors[id].color = unpackColor(in.next());
+    }
+    n = in.count(2);
+    ecs.sprites.reserve(n);
+    for (Uint32 i = 0; i < n; ++i) {
+        int id = in.entity(limit);
+        ecs.sprites[id].id = static_cast<Uint16>(in.next());
+    }
+    n = in.count(3);
+    for (Uint32 i = 0; i < n; ++i) {
+        Paddle& p = ecs.paddles[in.entity(limit)];
+        p.player = static_cast<int>(in.next());
+        p.points = static_cast<int>(in.next());
+    }
+    n = in.count(1);
+    for (Uint32 i = 0; i < n; ++i) ecs.balls[in.entity(limit)] = {};
+    n = in.count(2);
+    ecs.blocks.reserve(n);
+    for (Uint32 i = 0; i < n; ++i) {
+        int id = in.entity(limit);
+        ecs.blocks[id].active = in.next() != 0;
+    }
+    n = in.count(5);
+    for (Uint32 i = 0; i < n; ++i) {
+        Camera& c = ecs.cameras[in.entity(limit)];
+        c.x = bitsFloat(in.next());
+        c.y = bitsFloat(in.next());
+        c.w = static_cast<int>(in.next());
+        c.h = static_cast<int>(in.next());
+    }
+    if (!in.ok() || !validPaddlePlayers(ecs.paddles.begin(), ecs.paddles.end())) return false;
+
+    ecs.blockGrid.reset(SCREEN_WIDTH, ecs.worldHeight, GRID_CELL);
+    for (const auto& b : ecs.blocks) {
+        if (!b.second.active) continue;
+        const Position& p = ecs.positions[b.first];
+        ecs.blockGrid.insert(b.first, p.x, p.y, BLOCK_WIDTH, BLOCK_HEIGHT);
+    }
+    reserveScratch(ecs);
+    return true;
+}
+
+#endif